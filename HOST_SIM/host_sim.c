@@ -0,0 +1,357 @@
+/**
+ * @file host_sim.c
+ * @brief Backend de simulación en PC (Linux) para los protocolos emulados por software.
+ * Cada acceso a PORTx/LATx/TRISx (y sus variantes xbits) pasa por host_sim_registro(), que confirma las escrituras pendientes,
+ * avanza el reloj virtual y entrega una copia actualizada del registro. Las escrituras se detectan comparando dicha copia en el
+ * siguiente acceso o retardo, y los flancos resultantes se marcan con el ciclo del acceso que los produjo.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "host_sim.h"
+
+/**
+ * Estado interno de un puerto simulado
+*/
+typedef struct {
+    uint8_t lat;                //Latch de salida
+    uint8_t tris;               //Tri-estado (1 = entrada)
+    uint8_t ext_oe;             //Pines manejados por un dispositivo externo
+    uint8_t ext_nivel;          //Nivel impuesto por el dispositivo externo
+    uint8_t pullup;             //Nivel de los pines en entrada que nadie maneja
+    uint8_t nivel;              //Nivel actual de los pines
+    volatile uint8_t vista[3];  //Registros entregados al controlador (PORT, LAT, TRIS)
+    uint8_t copia[3];           //Contenido de las vistas al momento de entregarlas
+    uint8_t reportado[3];       //Últimos valores de PORT, LAT y TRIS notificados al monitor
+} host_sim_puerto_t;
+
+static host_sim_puerto_t puertos[HOST_SIM_NUM_PUERTOS];
+static uint64_t ciclos;                 //Reloj virtual en ciclos de instrucción (Fosc/4)
+static uint64_t ciclo_acceso;           //Ciclo del último acceso a registro
+static uint8_t costo_acceso = 1;        //Ciclos cargados por cada acceso a registro
+static host_sim_callback_t callback;
+static void *callback_contexto;
+static FILE *traza;
+static host_sim_monitor_t monitor;
+static void *monitor_contexto;
+
+/**
+ * Estado de un temporizador simulado
+*/
+typedef struct {
+    uint32_t periodo;           //Periodo en ciclos de instrucción (0 = deshabilitado)
+    uint64_t siguiente;         //Ciclo del siguiente disparo
+    host_sim_isr_t isr;
+} host_sim_timer_t;
+
+static host_sim_timer_t timers[HOST_SIM_NUM_TIMERS];
+
+/**
+ * Registros sin comportamiento simulado (ver xc.h)
+*/
+volatile uint8_t host_sim_INTCON, host_sim_INTCON2, host_sim_INTCON3, host_sim_PIR1, host_sim_PIE1, host_sim_T1CON;
+volatile uint16_t host_sim_TMR1;
+static uint8_t en_isr;                  //Evita el anidamiento de interrupciones
+
+/**
+ * @brief Función interna que notifica al monitor los cambios de TRIS, LAT y PORT de un puerto, en ese orden (causa antes que efecto)
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param ciclo (uint64_t): Marca de tiempo de los cambios
+ * @return (void)
+*/
+static void host_sim_monitorear(uint8_t puerto, uint64_t ciclo) {
+    static const uint8_t vistas[3] = {HOST_SIM_TRIS, HOST_SIM_LAT, HOST_SIM_PORT};
+    host_sim_puerto_t *p = &puertos[puerto];
+    uint8_t valores[3];
+    host_sim_cambio_t cambio;
+    valores[HOST_SIM_PORT] = p->nivel;
+    valores[HOST_SIM_LAT] = p->lat;
+    valores[HOST_SIM_TRIS] = p->tris;
+    for(uint8_t i=0;i!=3;i++) {
+        uint8_t vista = vistas[i];
+        if(valores[vista] == p->reportado[vista])
+            continue;
+        p->reportado[vista] = valores[vista];
+        cambio.ciclo = ciclo;
+        cambio.puerto = puerto;
+        cambio.vista = vista;
+        cambio.valor = valores[vista];
+        monitor(&cambio,monitor_contexto);
+    }
+}
+
+/**
+ * @brief Función interna que recalcula el nivel de los pines de un puerto y notifica los flancos resultantes
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param ciclo (uint64_t): Marca de tiempo de los flancos
+ * @return (void)
+*/
+static void host_sim_actualizar(uint8_t puerto, uint64_t ciclo) {
+    host_sim_puerto_t *p = &puertos[puerto];
+    uint8_t entrada = (p->ext_oe & p->ext_nivel) | (~p->ext_oe & p->pullup);
+    uint8_t nuevo = (p->lat & ~p->tris) | (entrada & p->tris);
+    uint8_t cambios = nuevo ^ p->nivel;
+    host_sim_flanco_t flanco;
+    p->nivel = nuevo;   //Se actualiza antes de notificar, para que el callback vea el estado nuevo
+    if(monitor)
+        host_sim_monitorear(puerto,ciclo);
+    for(uint8_t pin=0;cambios;pin++,cambios>>=1) {
+        if(!(cambios & 0x01))
+            continue;
+        flanco.ciclo = ciclo;
+        flanco.puerto = puerto;
+        flanco.pin = pin;
+        flanco.nivel = (nuevo>>pin) & 0x01;
+        if(traza)
+            fprintf(traza,"%llu R%c%u %u\n",(unsigned long long)ciclo,'A'+puerto,pin,flanco.nivel);
+        if(callback)
+            callback(&flanco,callback_contexto);
+    }
+}
+
+/**
+ * @brief Función interna que avanza el reloj virtual, disparando en orden las rutinas de los temporizadores cuyo periodo se cumpla
+ * @param n (uint64_t): Ciclos a avanzar
+ * @return (void)
+*/
+static void host_sim_avanzar(uint64_t n) {
+    uint64_t destino = ciclos + n;
+    if(en_isr) {
+        ciclos = destino;
+        return;
+    }
+    for(;;) {
+        host_sim_timer_t *proximo = NULL;
+        for(uint8_t i=0;i!=HOST_SIM_NUM_TIMERS;i++) {
+            if(timers[i].periodo && timers[i].siguiente <= destino && (!proximo || timers[i].siguiente < proximo->siguiente))
+                proximo = &timers[i];
+        }
+        if(!proximo)
+            break;
+        if(proximo->siguiente > ciclos)
+            ciclos = proximo->siguiente;
+        proximo->siguiente += proximo->periodo;
+        en_isr = 1;
+        proximo->isr();
+        host_sim_sync();
+        en_isr = 0;
+        if(ciclos > destino)    //La rutina de interrupción consume ciclos del código interrumpido
+            destino = ciclos;
+    }
+    ciclos = destino;
+}
+
+/**
+ * @brief Función que reinicia el simulador: reloj en cero, todos los pines como entrada con pullup y sin dispositivos externos
+ * @param (void)
+ * @return (void)
+*/
+void host_sim_reset(void) {
+    for(uint8_t i=0;i!=HOST_SIM_NUM_PUERTOS;i++) {
+        host_sim_puerto_t *p = &puertos[i];
+        p->lat = 0x00;
+        p->tris = 0xFF;
+        p->ext_oe = 0x00;
+        p->ext_nivel = 0xFF;
+        p->pullup = 0xFF;
+        p->nivel = 0xFF;
+        p->vista[HOST_SIM_PORT] = p->copia[HOST_SIM_PORT] = p->nivel;
+        p->vista[HOST_SIM_LAT] = p->copia[HOST_SIM_LAT] = p->lat;
+        p->vista[HOST_SIM_TRIS] = p->copia[HOST_SIM_TRIS] = p->tris;
+        p->reportado[HOST_SIM_PORT] = p->nivel;
+        p->reportado[HOST_SIM_LAT] = p->lat;
+        p->reportado[HOST_SIM_TRIS] = p->tris;
+    }
+    for(uint8_t i=0;i!=HOST_SIM_NUM_TIMERS;i++)
+        timers[i].periodo = 0;
+    ciclos = 0;
+    ciclo_acceso = 0;
+    en_isr = 0;
+}
+
+/**
+ * @brief Función que confirma las escrituras hechas por el controlador sobre las vistas de registros y las refresca.
+ * Una escritura a PORTx se refleja en LATx únicamente en los bits modificados.
+ * @param (void)
+ * @return (void)
+*/
+void host_sim_sync(void) {
+    for(uint8_t i=0;i!=HOST_SIM_NUM_PUERTOS;i++) {
+        host_sim_puerto_t *p = &puertos[i];
+        uint8_t port = p->vista[HOST_SIM_PORT];
+        uint8_t lat = p->vista[HOST_SIM_LAT];
+        uint8_t tris = p->vista[HOST_SIM_TRIS];
+        if(lat != p->copia[HOST_SIM_LAT])
+            p->lat = lat;
+        if(tris != p->copia[HOST_SIM_TRIS])
+            p->tris = tris;
+        if(port != p->copia[HOST_SIM_PORT]) {
+            uint8_t modificados = port ^ p->copia[HOST_SIM_PORT];
+            p->lat = (p->lat & ~modificados) | (port & modificados);
+        }
+        host_sim_actualizar(i,ciclo_acceso);
+    }
+    for(uint8_t i=0;i!=HOST_SIM_NUM_PUERTOS;i++) {  //Los callbacks pudieron modificar otros puertos
+        host_sim_puerto_t *p = &puertos[i];
+        p->vista[HOST_SIM_PORT] = p->copia[HOST_SIM_PORT] = p->nivel;
+        p->vista[HOST_SIM_LAT] = p->copia[HOST_SIM_LAT] = p->lat;
+        p->vista[HOST_SIM_TRIS] = p->copia[HOST_SIM_TRIS] = p->tris;
+    }
+}
+
+/**
+ * @brief Función de acceso a registros utilizada por las macros de xc.h. Cada acceso cuesta host_sim_setCostoAcceso() ciclos.
+ * @param puerto (uint8_t): Índice del puerto simulado (HOST_SIM_PUERTO_x)
+ * @param vista (uint8_t): Registro solicitado (HOST_SIM_PORT, HOST_SIM_LAT o HOST_SIM_TRIS)
+ * @return (volatile uint8_t *) Apuntador al registro, válido hasta el siguiente acceso
+*/
+volatile uint8_t *host_sim_registro(uint8_t puerto, uint8_t vista) {
+    host_sim_sync();
+    host_sim_avanzar(costo_acceso);
+    ciclo_acceso = ciclos;
+    return &puertos[puerto].vista[vista];
+}
+
+/**
+ * @brief Función de retardo en ciclos de instrucción, equivalente a _delay() de XC8
+ * @param n (uint32_t): Cantidad de ciclos de instrucción
+ * @return (void)
+*/
+void host_sim_delay(uint32_t n) {
+    host_sim_sync();
+    host_sim_avanzar(n);
+}
+
+/**
+ * @brief Función que obtiene el valor del reloj virtual
+ * @param (void)
+ * @return (uint64_t) Ciclos de instrucción transcurridos desde host_sim_reset()
+*/
+uint64_t host_sim_getCiclos(void) {
+    return ciclos;
+}
+
+/**
+ * @brief Función que establece el costo en ciclos de cada acceso a registro (modelo simple de costo de instrucciones)
+ * @param n (uint8_t): Ciclos por acceso
+ * @return (void)
+*/
+void host_sim_setCostoAcceso(uint8_t n) {
+    costo_acceso = n;
+}
+
+/**
+ * @brief Función que registra la función a invocar en cada flanco
+ * @param cb (host_sim_callback_t): Función a invocar, NULL para deshabilitar
+ * @param contexto (void *): Apuntador que se entrega sin cambios a la función
+ * @return (void)
+*/
+void host_sim_setCallback(host_sim_callback_t cb, void *contexto) {
+    callback = cb;
+    callback_contexto = contexto;
+}
+
+/**
+ * @brief Función que habilita la impresión de flancos en formato de texto "ciclo pin nivel" (p. ej. "1234 RB0 1")
+ * @param archivo (FILE *): Archivo de salida, NULL para deshabilitar
+ * @return (void)
+*/
+void host_sim_setTraza(FILE *archivo) {
+    traza = archivo;
+}
+
+/**
+ * @brief Función que registra el monitor de cambios de registros (ver host_sim_grabador.h). Al registrarlo se toman los valores
+ * actuales como referencia, por lo que sólo se notifican los cambios posteriores.
+ * @param mon (host_sim_monitor_t): Función a invocar, NULL para deshabilitar
+ * @param contexto (void *): Apuntador que se entrega sin cambios a la función
+ * @return (void)
+*/
+void host_sim_setMonitor(host_sim_monitor_t mon, void *contexto) {
+    host_sim_sync();
+    for(uint8_t i=0;i!=HOST_SIM_NUM_PUERTOS;i++) {
+        host_sim_puerto_t *p = &puertos[i];
+        p->reportado[HOST_SIM_PORT] = p->nivel;
+        p->reportado[HOST_SIM_LAT] = p->lat;
+        p->reportado[HOST_SIM_TRIS] = p->tris;
+    }
+    monitor = mon;
+    monitor_contexto = contexto;
+}
+
+/**
+ * @brief Función con la que un dispositivo externo simulado maneja pines del puerto. Sólo tiene efecto sobre pines configurados como entrada.
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param mascara (uint8_t): Pines a manejar
+ * @param nivel (uint8_t): Nivel a imponer en dichos pines
+ * @return (void)
+*/
+void host_sim_drive(uint8_t puerto, uint8_t mascara, uint8_t nivel) {
+    host_sim_puerto_t *p = &puertos[puerto];
+    host_sim_sync();
+    p->ext_oe |= mascara;
+    p->ext_nivel = (p->ext_nivel & ~mascara) | (nivel & mascara);
+    host_sim_actualizar(puerto,ciclos);
+    p->vista[HOST_SIM_PORT] = p->copia[HOST_SIM_PORT] = p->nivel;
+}
+
+/**
+ * @brief Función con la que un dispositivo externo simulado libera pines del puerto (quedan al nivel de pullup)
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param mascara (uint8_t): Pines a liberar
+ * @return (void)
+*/
+void host_sim_release(uint8_t puerto, uint8_t mascara) {
+    host_sim_puerto_t *p = &puertos[puerto];
+    host_sim_sync();
+    p->ext_oe &= ~mascara;
+    host_sim_actualizar(puerto,ciclos);
+    p->vista[HOST_SIM_PORT] = p->copia[HOST_SIM_PORT] = p->nivel;
+}
+
+/**
+ * @brief Función que define el nivel de reposo de los pines en entrada que nadie maneja (1 = resistor pullup)
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param mascara (uint8_t): Pines con pullup
+ * @return (void)
+*/
+void host_sim_setPullups(uint8_t puerto, uint8_t mascara) {
+    host_sim_sync();
+    puertos[puerto].pullup = mascara;
+    host_sim_actualizar(puerto,ciclos);
+    puertos[puerto].vista[HOST_SIM_PORT] = puertos[puerto].copia[HOST_SIM_PORT] = puertos[puerto].nivel;
+}
+
+/**
+ * @brief Funciones de lectura del estado del puerto sin costo de ciclos, para uso de modelos externos y pruebas
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @return (uint8_t) Nivel de pines, latch o tri-estado
+*/
+uint8_t host_sim_getPines(uint8_t puerto) {
+    host_sim_sync();
+    return puertos[puerto].nivel;
+}
+
+uint8_t host_sim_getLat(uint8_t puerto) {
+    host_sim_sync();
+    return puertos[puerto].lat;
+}
+
+uint8_t host_sim_getTris(uint8_t puerto) {
+    host_sim_sync();
+    return puertos[puerto].tris;
+}
+
+/**
+ * @brief Función que configura un temporizador simulado, equivalente a un temporizador con interrupción por periodo
+ * @param timer (uint8_t): Índice del temporizador (0 a HOST_SIM_NUM_TIMERS-1)
+ * @param periodo (uint32_t): Periodo en ciclos de instrucción, 0 para deshabilitar
+ * @param isr (host_sim_isr_t): Rutina a invocar en cada periodo
+ * @return (void)
+*/
+void host_sim_setTimer(uint8_t timer, uint32_t periodo, host_sim_isr_t isr) {
+    timers[timer].periodo = periodo;
+    timers[timer].siguiente = ciclos + periodo;
+    timers[timer].isr = isr;
+}
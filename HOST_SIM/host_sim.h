@@ -0,0 +1,99 @@
+/**
+ * @file host_sim.h
+ * @brief Backend de simulación en PC (Linux) para los protocolos emulados por software.
+ * Sustituye los registros PORTx/LATx/TRISx del microcontrolador por un puerto simulado con reloj virtual de ciclos de instrucción,
+ * de manera que los archivos i2c_sw.c, spi_sw.c y serial_sw.c compilen sin modificaciones con gcc/g++ y generen flancos con marca de tiempo.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#ifndef HOST_SIM_H
+#define	HOST_SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Puertos simulados (A a E, como en la familia PIC18)
+*/
+#define HOST_SIM_NUM_PUERTOS    5
+#define HOST_SIM_PUERTO_A       0
+#define HOST_SIM_PUERTO_B       1
+#define HOST_SIM_PUERTO_C       2
+#define HOST_SIM_PUERTO_D       3
+#define HOST_SIM_PUERTO_E       4
+
+/**
+ * Vistas de cada puerto: PORTx (nivel de pines), LATx (latch de salida) y TRISx (tri-estado, 1 = entrada)
+*/
+#define HOST_SIM_PORT   0
+#define HOST_SIM_LAT    1
+#define HOST_SIM_TRIS   2
+
+/**
+ * Flanco registrado en un pin del puerto simulado
+*/
+typedef struct {
+    uint64_t ciclo;     //Ciclo de instrucción en el que ocurrió la escritura que produjo el flanco
+    uint8_t puerto;     //HOST_SIM_PUERTO_x
+    uint8_t pin;        //Número de bit (0-7)
+    uint8_t nivel;      //Nivel lógico después del flanco
+} host_sim_flanco_t;
+
+/**
+ * Función que se invoca en cada flanco. Puede llamar a host_sim_drive()/host_sim_release() para modelar dispositivos externos.
+*/
+typedef void (*host_sim_callback_t)(const host_sim_flanco_t *flanco, void *contexto);
+
+/**
+ * Cambio registrado en una vista de un puerto simulado (PORTx, LATx o TRISx), con el valor completo del registro después del cambio
+*/
+typedef struct {
+    uint64_t ciclo;     //Ciclo de instrucción en el que ocurrió el cambio
+    uint8_t puerto;     //HOST_SIM_PUERTO_x
+    uint8_t vista;      //HOST_SIM_PORT, HOST_SIM_LAT o HOST_SIM_TRIS
+    uint8_t valor;      //Valor del registro después del cambio
+} host_sim_cambio_t;
+
+/**
+ * Función que se invoca en cada cambio de PORTx, LATx o TRISx, antes de notificar los flancos. Es de sólo observación: no debe
+ * modificar el estado del simulador.
+*/
+typedef void (*host_sim_monitor_t)(const host_sim_cambio_t *cambio, void *contexto);
+
+/**
+ * Temporizadores simulados: invocan una función (rutina de interrupción) cada cierto número de ciclos de instrucción.
+ * No se anidan: mientras se ejecuta una rutina no se disparan otras, como ocurre con GIE en el microcontrolador.
+*/
+#define HOST_SIM_NUM_TIMERS     4
+
+typedef void (*host_sim_isr_t)(void);
+
+/**
+ * Prototipos de funciones
+*/
+void host_sim_reset(void);
+volatile uint8_t *host_sim_registro(uint8_t puerto, uint8_t vista);
+void host_sim_sync(void);
+void host_sim_delay(uint32_t ciclos);
+uint64_t host_sim_getCiclos(void);
+void host_sim_setCostoAcceso(uint8_t ciclos);
+void host_sim_setCallback(host_sim_callback_t callback, void *contexto);
+void host_sim_setTraza(FILE *archivo);
+void host_sim_setMonitor(host_sim_monitor_t monitor, void *contexto);
+void host_sim_drive(uint8_t puerto, uint8_t mascara, uint8_t nivel);
+void host_sim_release(uint8_t puerto, uint8_t mascara);
+void host_sim_setPullups(uint8_t puerto, uint8_t mascara);
+uint8_t host_sim_getPines(uint8_t puerto);
+uint8_t host_sim_getLat(uint8_t puerto);
+uint8_t host_sim_getTris(uint8_t puerto);
+void host_sim_setTimer(uint8_t timer, uint32_t periodo, host_sim_isr_t isr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* HOST_SIM_H */
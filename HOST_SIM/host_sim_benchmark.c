@@ -0,0 +1,1486 @@
+/**
+ * @file host_sim_benchmark.c
+ * @brief Programa para PC que mide el rendimiento de las funciones públicas de i2c_sw, spi_sw y serial_sw con el modelo de costo
+ * de host_sim. Por cada función reporta bits útiles por segundo, ciclos por byte y sobrecosto respecto a la tasa teórica de la
+ * línea (SCK, SCL a 8 bits de dato por 9 pulsos, o la velocidad en baudios a 8 bits de dato por trama de 10), en formato CSV, y
+ * verifica los datos transferidos contra esclavos i2c y SPI, un maestro i2c y un transmisor UART simulados (las tramas transmitidas
+ * se decodifican con el grabador). Las funciones sin carga útil (START, STOP, setMode, recuperarBus, etc.) se reportan por llamada,
+ * con bytes en 0. SPI se mide en cada modo compilado (columna modo).
+ * _XTAL_FREQ y las opciones de los controladores se fijan en tiempo de compilación, por lo que se compila una vez por cada frecuencia
+ * y variante de opciones (columna variante, BENCHMARK_VARIANTE); host_sim_benchmark.sh compila y ejecuta todas las combinaciones y
+ * genera el CSV completo. host_sim_benchmark.h debe incluirse en todas las unidades de compilación:
+ * gcc -O2 -D_XTAL_FREQ=32000000UL -I HOST_SIM -include HOST_SIM/host_sim_benchmark.h HOST_SIM/host_sim_benchmark.c HOST_SIM/host_sim.c
+ *     HOST_SIM/host_sim_grabador.c I2C_SW/i2c_sw.c SPI_SW/spi_sw.c SERIAL_SW/serial_sw.c -o benchmark
+ * Uso: benchmark [costo_acceso] [-s]   (costo por acceso a registro, 1 por defecto; -s omite el encabezado CSV)
+ * i2c_sw_ack() e i2c_sw_nack() no se miden: están declaradas en i2c_sw.h pero no tienen implementación.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xc.h"
+#include "host_sim_grabador.h"
+#include "host_sim_benchmark.h"
+#include "../../utils/utils.h"
+#define i2c_sw_INT16_TX
+#define i2c_sw_INT32_TX
+#define i2c_sw_FLOAT_TX
+#include "../I2C_SW/i2c_sw.h"
+#include "../SPI_SW/spi_sw.h"
+#include "../SERIAL_SW/serial_sw.h"
+
+#ifndef BENCHMARK_VARIANTE
+#define BENCHMARK_VARIANTE  "base"      //Nombre de la combinación de opciones de compilación
+#endif
+
+#define BENCHMARK_BYTES     64          //Bytes de carga útil por medición
+#define BENCHMARK_NA        -1          //Resultado sin verificación de datos, o función sin modo SPI
+#define BENCHMARK_TIMEOUT   (2UL*BENCHMARK_BYTES*10*CYCLES_BIT_PERIOD)     //Tiempo límite de las lecturas con espera acotada
+#define BENCHMARK_LATENCIA  4           //Ciclos de la entrada a una interrupción por flanco
+#define BENCHMARK_BLOQUE    16          //Bytes por lectura con recepción en segundo plano (menos que el buffer)
+
+#define NUM_ELEMENTOS(a) (sizeof(a)/sizeof((a)[0]))
+
+//Con transmisión por interrupción la medición incluye el vaciado del buffer
+#ifdef SERIAL_SW_TX_ISR
+#define ESPERAR_TX() serial_sw_flush();
+#else
+#define ESPERAR_TX()
+#endif
+
+//Con recepción por interrupción las lecturas sólo toman lo disponible: la medición incluye la espera de los bytes
+#ifdef SERIAL_SW_RX_ISR
+#define ESPERAR_RX(n) if(!esperarRX(n)) return false;
+#else
+#define ESPERAR_RX(n)
+#endif
+
+static uint8_t costo = 1;
+static uint64_t ciclo_inicio;
+static int modo_spi = BENCHMARK_NA;
+
+/**
+ * Patrón de datos que envían los esclavos simulados: byte n de la medición
+*/
+static uint8_t patron(uint16_t n) {
+    return (uint8_t)(0xC3 ^ (7*n));
+}
+
+#if defined(I2C_SW_LANES) && !defined(SLAVE_MODE_SW)
+/**
+ * Patrón de datos del canal n en los modos multicanal, distinto en cada canal
+*/
+static uint8_t patronCanal(uint16_t n, uint8_t canal) {
+    return (uint8_t)(patron(n) ^ (0x11*canal));
+}
+#endif
+
+/**
+ * TMR1 simulado (ver host_sim_benchmark.h): el vencimiento se lleva por separado para que la recarga, igual que TMR1 += recarga,
+ * se cuente desde el vencimiento anterior y no desde la llamada.
+*/
+static uint64_t tmr1_vencimiento;
+static host_sim_isr_t tmr1_isr;
+static uint8_t rx_flanco_habilitado;
+
+/**
+ * @brief Función que arranca TMR1 simulado
+ * @param ciclos (uint32_t): Ciclos hasta la primera interrupción y periodo
+ * @param isr (host_sim_isr_t): Rutina de interrupción
+ * @return (void)
+*/
+void benchmark_tmr1_iniciar(uint32_t ciclos, host_sim_isr_t isr) {
+    tmr1_isr = isr;
+    tmr1_vencimiento = host_sim_getCiclos() + ciclos;
+    host_sim_setTimer(BENCHMARK_TIMER_TMR1,ciclos,isr);
+}
+
+/**
+ * @brief Función que programa la siguiente interrupción de TMR1 simulado, contada desde el vencimiento anterior
+ * @param ciclos (uint32_t): Ciclos desde el vencimiento anterior
+ * @return (void)
+*/
+void benchmark_tmr1_recargar(uint32_t ciclos) {
+    uint64_t ahora = host_sim_getCiclos();
+    tmr1_vencimiento += ciclos;
+    host_sim_setTimer(BENCHMARK_TIMER_TMR1,(tmr1_vencimiento > ahora)? (uint32_t)(tmr1_vencimiento - ahora) : 1,tmr1_isr);
+}
+
+/**
+ * @brief Función que detiene TMR1 simulado
+ * @param (void)
+ * @return (void)
+*/
+void benchmark_tmr1_detener(void) {
+    host_sim_setTimer(BENCHMARK_TIMER_TMR1,0,NULL);
+}
+
+/**
+ * @brief Función que habilita o deshabilita la interrupción por flanco de bajada de SW_RX (RB7) simulada
+ * @param habilitar (uint8_t): 1 para habilitar, 0 para deshabilitar
+ * @return (void)
+*/
+void benchmark_rx_flanco(uint8_t habilitar) {
+    rx_flanco_habilitado = habilitar;
+}
+
+#if defined(SERIAL_SW_RX_ISR) && !defined(SERIAL_SW_FULL_DUPLEX)
+/**
+ * @brief Rutina de un solo disparo que atiende el flanco de SW_RX después de la latencia de la interrupción
+ * @param (void)
+ * @return (void)
+*/
+static void rx_flanco_isr(void) {
+    host_sim_setTimer(BENCHMARK_TIMER_FLANCO,0,NULL);
+    serial_sw_rx_edge_isr();
+}
+
+/**
+ * @brief Función invocada por host_sim en cada flanco, que emula la interrupción por flanco de bajada de SW_RX
+ * @param flanco (const host_sim_flanco_t *): Flanco notificado
+ * @param contexto (void *): Sin uso
+ * @return (void)
+*/
+static void rx_flanco(const host_sim_flanco_t *flanco, void *contexto) {
+    (void)contexto;
+    if(rx_flanco_habilitado && flanco->puerto == HOST_SIM_PUERTO_B && flanco->pin == 7 && !flanco->nivel)
+        host_sim_setTimer(BENCHMARK_TIMER_FLANCO,BENCHMARK_LATENCIA,rx_flanco_isr);
+}
+#endif
+
+/**
+ * Transmisor UART simulado que maneja SW_RX (RB7) desde un temporizador con periodo de un bit, para medir la recepción. Las tramas
+ * marcadas en tx_sim_invalidas se envían con STOP en bajo, seguido de un bit en alto para que el receptor resincronice. Tras
+ * 2*BENCHMARK_BYTES tramas de inactividad envía 0xFF de relleno, separados por una trama inactiva, hasta que se detiene, para que una lectura bloqueante que perdió
+ * tramas termine (y falle la verificación) en vez de esperar indefinidamente.
+*/
+static uint8_t tx_sim_datos[BENCHMARK_BYTES+1];
+static uint16_t tx_sim_len, tx_sim_pos;
+static uint8_t tx_sim_bit, tx_sim_invalidas;
+static uint16_t tx_sim_inactivo;
+static uint32_t tx_sim_periodo = CYCLES_BIT_PERIOD;
+
+/**
+ * @brief Rutina del temporizador del transmisor simulado: un bit por llamada (START, 8 datos del LSB al MSB, STOP)
+ * @param (void)
+ * @return (void)
+*/
+static void tx_sim_isr(void) {
+    uint8_t nivel;
+    uint8_t invalida = tx_sim_pos < 8 && (tx_sim_invalidas & (1<<tx_sim_pos));
+    if(tx_sim_pos == tx_sim_len) {
+        if(tx_sim_inactivo < 2*BENCHMARK_BYTES*10) {
+            tx_sim_inactivo++;
+            host_sim_drive(HOST_SIM_PUERTO_B,0x80,0x80);
+        } else {
+            host_sim_drive(HOST_SIM_PUERTO_B,0x80,tx_sim_bit? 0x80 : 0x00);
+            if(++tx_sim_bit == 20)     //Una trama de inactividad entre rellenos para que resincronice un receptor lento
+                tx_sim_bit = 0;
+        }
+        return;
+    }
+    if(tx_sim_bit == 0)
+        nivel = 0;
+    else if(tx_sim_bit < 9)
+        nivel = (tx_sim_datos[tx_sim_pos]>>(tx_sim_bit-1)) & 0x01;
+    else
+        nivel = (tx_sim_bit == 10 || !invalida);
+    host_sim_drive(HOST_SIM_PUERTO_B,0x80,nivel? 0x80 : 0x00);
+    if(++tx_sim_bit == (invalida? 11 : 10)) {
+        tx_sim_bit = 0;
+        tx_sim_pos++;
+    }
+}
+
+/**
+ * @brief Función que carga datos en el transmisor simulado y lo arranca a la velocidad de tx_sim_periodo
+ * @param datos (const uint8_t *): Datos a transmitir
+ * @param len (uint16_t): Número de bytes (a lo más BENCHMARK_BYTES+1)
+ * @param invalidas (uint8_t): Máscara de las tramas (0 a 7) que se envían con STOP en bajo
+ * @return (void)
+*/
+static void tx_sim_enviar(const uint8_t *datos, uint16_t len, uint8_t invalidas) {
+    memcpy(tx_sim_datos,datos,len);
+    tx_sim_len = len;
+    tx_sim_pos = 0;
+    tx_sim_bit = 0;
+    tx_sim_invalidas = invalidas;
+    tx_sim_inactivo = 0;
+    host_sim_setTimer(BENCHMARK_TIMER_EXTERNO,tx_sim_periodo,tx_sim_isr);
+}
+
+/**
+ * @brief Función que espera a que el transmisor simulado termine (una lectura fallida deja tramas pendientes) y lo detiene
+ * @param (void)
+ * @return (void)
+*/
+static void tx_sim_esperar(void) {
+    while(tx_sim_pos != tx_sim_len)
+        _delay(tx_sim_periodo);
+    _delay(2*tx_sim_periodo);
+    host_sim_setTimer(BENCHMARK_TIMER_EXTERNO,0,NULL);
+}
+
+#ifndef SLAVE_MODE_SW
+/**
+ * Esclavos i2c simulados (SDA en RB0, o un esclavo por canal en el puerto de I2C_SW_LANES; SCL en RB1) que reconocen cualquier
+ * dirección y contestan ACK a cada byte escrito, guardándolo en rx. En lectura envían patron(0), patron(1), ... (patronCanal en
+ * multicanal) hasta que el maestro responde NACK.
+*/
+enum {I2C_SIM_LIBRE, I2C_SIM_DIRECCION, I2C_SIM_ESCRITURA, I2C_SIM_LECTURA};
+typedef struct {
+    uint8_t estado, bits, dato;
+    uint8_t rx[BENCHMARK_BYTES+2];
+    uint16_t num_rx, num_tx;
+} i2c_sim_t;
+static i2c_sim_t i2c_sim[8];
+static uint8_t i2c_sim_puerto = HOST_SIM_PUERTO_B;
+static uint8_t i2c_sim_mascara = 0x01;     //Canales con esclavo: bit n = SDA en el pin n de i2c_sim_puerto
+
+/**
+ * @brief Función interna del esclavo i2c simulado que coloca un bit en SDA (1 libera la línea)
+ * @param canal (uint8_t): Canal del esclavo
+ * @param nivel (uint8_t): Nivel del bit
+ * @return (void)
+*/
+static void i2c_sim_sda(uint8_t canal, uint8_t nivel) {
+    if(nivel)
+        host_sim_release(i2c_sim_puerto,1<<canal);
+    else
+        host_sim_drive(i2c_sim_puerto,1<<canal,0x00);
+}
+
+/**
+ * @brief Función interna que atiende un flanco de SCL en el esclavo de un canal
+ * @param canal (uint8_t): Canal del esclavo
+ * @param nivel (uint8_t): Nivel de SCL después del flanco
+ * @param sda (uint8_t): Nivel de SDA del canal
+ * @return (void)
+*/
+static void i2c_sim_scl(uint8_t canal, uint8_t nivel, uint8_t sda) {
+    i2c_sim_t *s = &i2c_sim[canal];
+    uint8_t dato = patron(s->num_tx);
+#ifdef I2C_SW_LANES
+    if(i2c_sim_puerto != HOST_SIM_PUERTO_B)
+        dato = patronCanal(s->num_tx,canal);
+#endif
+    if(s->estado == I2C_SIM_LIBRE)
+        return;
+    if(nivel) {                                     //Subida de SCL: muestreo
+        if(s->bits < 8) {
+            s->dato = (s->dato<<1) | sda;
+        } else if(s->bits == 8 && s->estado == I2C_SIM_LECTURA) {
+            if(sda)                                 //NACK del maestro: fin de la lectura
+                s->estado = I2C_SIM_LIBRE;
+            else
+                s->num_tx++;
+        }
+        s->bits++;
+        return;
+    }
+    //Bajada de SCL
+    if(s->bits == 8) {                              //Después del octavo bit: ACK del esclavo, o del maestro en lectura
+        if(s->estado == I2C_SIM_DIRECCION) {
+            i2c_sim_sda(canal,0);
+        } else if(s->estado == I2C_SIM_ESCRITURA) {
+            if(s->num_rx != sizeof(s->rx))
+                s->rx[s->num_rx++] = s->dato;
+            i2c_sim_sda(canal,0);
+        } else {
+            i2c_sim_sda(canal,1);
+        }
+    } else if(s->bits == 9) {                       //Después del ACK; la dirección fija el sentido de la transacción
+        s->bits = 0;
+        if(s->estado == I2C_SIM_DIRECCION)
+            s->estado = (s->dato & 0x01)? I2C_SIM_LECTURA : I2C_SIM_ESCRITURA;
+        if(s->estado == I2C_SIM_LECTURA)
+            i2c_sim_sda(canal,dato & 0x80);
+        else
+            i2c_sim_sda(canal,1);
+    } else if(s->estado == I2C_SIM_LECTURA) {
+        i2c_sim_sda(canal,(dato<<s->bits) & 0x80);
+    }
+}
+
+/**
+ * @brief Función invocada por host_sim en cada flanco, que implementa los esclavos i2c simulados
+ * @param flanco (const host_sim_flanco_t *): Flanco notificado
+ * @param contexto (void *): Sin uso
+ * @return (void)
+*/
+static void i2c_sim_flanco(const host_sim_flanco_t *flanco, void *contexto) {
+    uint8_t sda = host_sim_getPines(i2c_sim_puerto);
+    (void)contexto;
+    if(flanco->puerto == HOST_SIM_PUERTO_B && flanco->pin == 1) {
+        for(uint8_t canal=0;canal!=8;canal++) {
+            if(i2c_sim_mascara & (1<<canal))
+                i2c_sim_scl(canal,flanco->nivel,(sda>>canal) & 0x01);
+        }
+    } else if(flanco->puerto == i2c_sim_puerto && (i2c_sim_mascara & (1<<flanco->pin)) &&
+              (host_sim_getPines(HOST_SIM_PUERTO_B) & 0x02)) {     //SDA con SCL en alto: START o STOP
+        i2c_sim[flanco->pin].estado = flanco->nivel? I2C_SIM_LIBRE : I2C_SIM_DIRECCION;
+        i2c_sim[flanco->pin].bits = 0;
+    }
+}
+
+/**
+ * @brief Función que reinicia los contadores de los esclavos i2c simulados antes de cada medición
+ * @param (void)
+ * @return (void)
+*/
+static void i2c_sim_reiniciar(void) {
+    for(uint8_t canal=0;canal!=8;canal++) {
+        i2c_sim[canal].num_rx = 0;
+        i2c_sim[canal].num_tx = 0;
+    }
+}
+
+/**
+ * @brief Función que elige las líneas SDA de los esclavos i2c simulados y los deja en espera de START
+ * @param puerto (uint8_t): Puerto de las líneas SDA
+ * @param mascara (uint8_t): Pines SDA, uno por esclavo
+ * @return (void)
+*/
+static void i2c_sim_configurar(uint8_t puerto, uint8_t mascara) {
+    i2c_sim_puerto = puerto;
+    i2c_sim_mascara = mascara;
+    for(uint8_t canal=0;canal!=8;canal++)
+        i2c_sim[canal].estado = I2C_SIM_LIBRE;
+    i2c_sim_reiniciar();
+}
+#endif
+
+/**
+ * Esclavo SPI simulado (MOSI en RB0, MISO en RB1, SCK en RB2) en el modo de spi_sim_cpol y spi_sim_cpha: registro de corrimiento
+ * que muestrea MOSI en el flanco de muestreo del modo y coloca en MISO el siguiente bit de patron(0), patron(1), ... en el de
+ * propagación. Guarda lo recibido en spi_sim_rx y, con SPI_SW_LANES, lo de cada canal MOSI del puerto D en spi_sim_canales_rx
+ * (byte k del canal n en la posición 8*k+n, el orden de spi_sw_lanes_write).
+*/
+static uint8_t spi_sim_rx[BENCHMARK_BYTES];
+static uint16_t spi_sim_bytes;
+static uint8_t spi_sim_bits, spi_sim_dato, spi_sim_cpol, spi_sim_cpha;
+#ifdef SPI_SW_LANES
+static uint8_t spi_sim_canales[8], spi_sim_canales_rx[BENCHMARK_BYTES];
+#endif
+
+/**
+ * @brief Función interna del esclavo SPI simulado que coloca en MISO el siguiente bit a enviar
+ * @param (void)
+ * @return (void)
+*/
+static void spi_sim_miso(void) {
+    uint8_t nivel = (patron(spi_sim_bytes)<<spi_sim_bits) & 0x80;
+    host_sim_drive(HOST_SIM_PUERTO_B,0x02,nivel? 0x02 : 0x00);
+}
+
+/**
+ * @brief Función invocada por host_sim en cada flanco, que implementa el esclavo SPI simulado
+ * @param flanco (const host_sim_flanco_t *): Flanco notificado
+ * @param contexto (void *): Sin uso
+ * @return (void)
+*/
+static void spi_sim_flanco(const host_sim_flanco_t *flanco, void *contexto) {
+    (void)contexto;
+    if(flanco->puerto != HOST_SIM_PUERTO_B || flanco->pin != 2)
+        return;
+    if((flanco->nivel != spi_sim_cpol) != spi_sim_cpha) {      //Flanco de muestreo
+        spi_sim_dato = (spi_sim_dato<<1) | (host_sim_getPines(HOST_SIM_PUERTO_B) & 0x01);
+#ifdef SPI_SW_LANES
+        uint8_t canales = host_sim_getPines(HOST_SIM_PUERTO_D);
+        for(uint8_t canal=0;canal!=8;canal++)
+            spi_sim_canales[canal] = (spi_sim_canales[canal]<<1) | ((canales>>canal) & 0x01);
+#endif
+        if(++spi_sim_bits == 8) {
+            if(spi_sim_bytes < BENCHMARK_BYTES)
+                spi_sim_rx[spi_sim_bytes] = spi_sim_dato;
+#ifdef SPI_SW_LANES
+            if(spi_sim_bytes < BENCHMARK_BYTES/8) {
+                for(uint8_t canal=0;canal!=8;canal++)
+                    spi_sim_canales_rx[8*spi_sim_bytes+canal] = spi_sim_canales[canal];
+            }
+#endif
+            spi_sim_bytes++;
+            spi_sim_bits = 0;
+        }
+    } else {
+        spi_sim_miso();
+    }
+}
+
+/**
+ * @brief Función que reinicia el esclavo SPI simulado antes de cada medición
+ * @param (void)
+ * @return (void)
+*/
+static void spi_sim_reiniciar(void) {
+    spi_sim_bytes = 0;
+    spi_sim_bits = 0;
+#ifdef SPI_SW_LANES
+    memset(spi_sim_canales_rx,0,sizeof(spi_sim_canales_rx));
+#endif
+    spi_sim_miso();
+}
+
+/**
+ * @brief Función que reinicia el simulador antes de cada grupo de mediciones
+ * @param (void)
+ * @return (void)
+*/
+static void reiniciar(void) {
+    host_sim_reset();
+    host_sim_setCostoAcceso(costo);
+    host_sim_drive(HOST_SIM_PUERTO_B,0x80,0x80);    //SW_RX en reposo
+}
+
+/**
+ * @brief Función que marca el inicio de una medición
+ * @param (void)
+ * @return (void)
+*/
+static void iniciar(void) {
+    ciclo_inicio = host_sim_getCiclos();
+}
+
+/**
+ * @brief Función que imprime una línea CSV con el resultado de una medición iniciada con iniciar(). Sin carga útil (bytes en 0)
+ * se reportan los ciclos de la llamada y las tasas como NA. En los modos multicanal y full duplex bytes y bps_linea suman todos
+ * los canales (8 o 2 veces la tasa de una línea).
+ * @param driver (const char *): Nombre del protocolo
+ * @param funcion (const char *): Función medida
+ * @param bytes (uint32_t): Bytes de carga útil transferidos
+ * @param bps_linea (uint32_t): Tasa teórica de la línea en bits (pulsos de reloj o baudios) por segundo
+ * @param bits_linea (uint8_t): Bits de línea por byte de carga útil (8 en SPI, 9 en i2c, 10 en UART)
+ * @param verificado (int): 1 si los datos se verificaron, 0 si la verificación falló, BENCHMARK_NA si no se verifican
+ * @return (void)
+*/
+static void reportar(const char *driver, const char *funcion, uint32_t bytes, uint32_t bps_linea, uint8_t bits_linea, int verificado) {
+    uint64_t ciclos = host_sim_getCiclos() - ciclo_inicio;
+    double bps_teoricos = 8.0*bps_linea/bits_linea;
+    printf("%lu,%u,%s,%s,",(unsigned long)_XTAL_FREQ,costo,BENCHMARK_VARIANTE,driver);
+    if(modo_spi == BENCHMARK_NA)
+        printf("NA,");
+    else
+        printf("%d,",modo_spi);
+    printf("%s,%lu,%llu,",funcion,(unsigned long)bytes,(unsigned long long)ciclos);
+    if(bytes && ciclos) {
+        double bps = 8.0*bytes*(_XTAL_FREQ/4)/ciclos;
+        printf("%.2f,%.0f,%lu,%.0f,%.2f,",(double)ciclos/bytes,bps,(unsigned long)bps_linea,bps_teoricos,100.0*(bps_teoricos/bps - 1.0));
+    } else {
+        printf("NA,NA,%lu,%.0f,NA,",(unsigned long)bps_linea,bps_teoricos);
+    }
+    if(verificado == BENCHMARK_NA)
+        printf("NA\n");
+    else
+        printf("%d\n",verificado);
+}
+
+/**
+ * @brief Función que verifica que un arreglo contenga patron(0), patron(1), ...
+ * @param datos (const uint8_t *): Datos a verificar
+ * @param len (uint16_t): Número de bytes
+ * @return (int) 1 si coinciden, 0 en caso contrario
+*/
+static int verificarPatron(const uint8_t *datos, uint16_t len) {
+    for(uint16_t i=0;i!=len;i++) {
+        if(datos[i] != patron(i))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Función que verifica con el grabador las tramas transmitidas por un pin desde el inicio de la grabación
+ * @param puerto (uint8_t): Puerto de la línea TX (HOST_SIM_PUERTO_B para SW_TX)
+ * @param pin (uint8_t): Pin de la línea TX (6 para SW_TX)
+ * @param ciclos_bit (uint32_t): Periodo de bit nominal
+ * @param datos (const uint8_t *): Datos esperados
+ * @param len (uint16_t): Número de bytes esperados
+ * @return (int) 1 si las tramas coinciden con los datos, 0 en caso contrario
+*/
+static int verificarUART(uint8_t puerto, uint8_t pin, uint32_t ciclos_bit, const uint8_t *datos, uint16_t len) {
+    host_sim_uart_t tramas[BENCHMARK_BYTES+3];
+    size_t n = host_sim_grabador_medirUART(puerto,pin,ciclos_bit,tramas,NUM_ELEMENTOS(tramas));
+    if(n != len)
+        return 0;
+    for(size_t i=0;i!=n;i++) {
+        if(tramas[i].dato != datos[i] || tramas[i].error_trama)
+            return 0;
+    }
+    return 1;
+}
+
+#ifndef SLAVE_MODE_SW
+static void benchmark_i2c(void) {
+    uint32_t bps = 1000000000UL/(I2C_SW_T_LOW_NS + I2C_SW_T_HIGH_NS);
+    uint8_t tx[BENCHMARK_BYTES], rx[BENCHMARK_BYTES];
+    uint16_t valor16;
+    uint32_t valor32;
+    float flotante;
+    bool ack = true;
+    i2c_sw_estado_t estado;
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        tx[i] = (uint8_t)(0xA5 ^ i);
+    reiniciar();
+    i2c_sim_configurar(HOST_SIM_PUERTO_B,0x01);
+    host_sim_setCallback(i2c_sim_flanco,NULL);
+    iniciar();
+    i2c_sw_init();
+    reportar("i2c_sw","i2c_sw_init",0,bps,9,BENCHMARK_NA);
+    //Escritura por byte y con los auxiliares de varios bytes, dentro de una misma transacción
+    iniciar();
+    i2c_sw_start();
+    reportar("i2c_sw","i2c_sw_start",0,bps,9,BENCHMARK_NA);
+    i2c_sw_writeByte(0xA0);
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        ack &= i2c_sw_writeByte(tx[i]);
+    reportar("i2c_sw","i2c_sw_writeByte",BENCHMARK_BYTES,bps,9,ack && i2c_sim[0].num_rx == BENCHMARK_BYTES && !memcmp(i2c_sim[0].rx,tx,BENCHMARK_BYTES));
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor16)) {
+        memcpy(&valor16,&tx[i],sizeof(valor16));
+        i2c_sw_writeInt16(valor16);
+    }
+    reportar("i2c_sw","i2c_sw_writeInt16",BENCHMARK_BYTES,bps,9,i2c_sim[0].num_rx == BENCHMARK_BYTES && !memcmp(i2c_sim[0].rx,tx,BENCHMARK_BYTES));
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor32)) {
+        memcpy(&valor32,&tx[i],sizeof(valor32));
+        i2c_sw_writeInt32(valor32);
+    }
+    reportar("i2c_sw","i2c_sw_writeInt32",BENCHMARK_BYTES,bps,9,i2c_sim[0].num_rx == BENCHMARK_BYTES && !memcmp(i2c_sim[0].rx,tx,BENCHMARK_BYTES));
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(flotante)) {
+        memcpy(&flotante,&tx[i],sizeof(flotante));
+        i2c_sw_writeFloat(flotante);
+    }
+    reportar("i2c_sw","i2c_sw_writeFloat",BENCHMARK_BYTES,bps,9,i2c_sim[0].num_rx == BENCHMARK_BYTES && !memcmp(i2c_sim[0].rx,tx,BENCHMARK_BYTES));
+    //Lectura por byte después de RESTART
+    iniciar();
+    i2c_sw_restart();
+    reportar("i2c_sw","i2c_sw_restart",0,bps,9,BENCHMARK_NA);
+    i2c_sw_writeByte(0xA1);
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        rx[i] = i2c_sw_readByte(i != BENCHMARK_BYTES-1);
+    reportar("i2c_sw","i2c_sw_readByte",BENCHMARK_BYTES,bps,9,verificarPatron(rx,BENCHMARK_BYTES));
+    iniciar();
+    i2c_sw_stop();
+    reportar("i2c_sw","i2c_sw_stop",0,bps,9,BENCHMARK_NA);
+    iniciar();
+    estado = i2c_sw_getEstado();
+    reportar("i2c_sw","i2c_sw_getEstado",0,bps,9,estado == I2C_SW_OK);
+    //Bloques de registros: START, dirección y registro incluidos en la medición
+    i2c_sim_reiniciar();
+    iniciar();
+    ack = i2c_sw_writeRegs(0x50,0x00,tx,BENCHMARK_BYTES);
+    reportar("i2c_sw","i2c_sw_writeRegs",BENCHMARK_BYTES,bps,9,ack && i2c_sim[0].num_rx == BENCHMARK_BYTES+1 && !memcmp(i2c_sim[0].rx+1,tx,BENCHMARK_BYTES));
+    i2c_sim_reiniciar();
+    iniciar();
+    ack = i2c_sw_readRegs(0x50,0x00,rx,BENCHMARK_BYTES);
+    reportar("i2c_sw","i2c_sw_readRegs",BENCHMARK_BYTES,bps,9,ack && verificarPatron(rx,BENCHMARK_BYTES));
+    //Recuperación del bus: el esclavo quedó a la mitad de la lectura de un byte en cero (patron(101)), reteniendo SDA hasta el ACK
+    i2c_sim[0].estado = I2C_SIM_LECTURA;
+    i2c_sim[0].bits = 1;
+    i2c_sim[0].num_tx = 101;
+    i2c_sim_sda(0,0);
+    iniciar();
+    estado = i2c_sw_recuperarBus();
+    reportar("i2c_sw","i2c_sw_recuperarBus",0,bps,9,estado == I2C_SW_OK && i2c_sw_getEstado() == I2C_SW_OK &&
+        i2c_sim[0].estado == I2C_SIM_LIBRE && (host_sim_getPines(HOST_SIM_PUERTO_B) & 0x03) == 0x03);
+    host_sim_setCallback(NULL,NULL);
+}
+
+#ifdef I2C_SW_LANES
+static void benchmark_i2c_lanes(void) {
+    uint32_t bps = 8*(1000000000UL/(I2C_SW_T_LOW_NS + I2C_SW_T_HIGH_NS));
+    uint8_t tx[BENCHMARK_BYTES], rx[BENCHMARK_BYTES];
+    uint8_t ack;
+    int ok;
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        tx[i] = (uint8_t)(0xA5 ^ i);
+    reiniciar();
+    i2c_sim_configurar(HOST_SIM_PUERTO_D,0xFF);
+    host_sim_setCallback(i2c_sim_flanco,NULL);
+    i2c_sw_init();
+    iniciar();
+    i2c_sw_lanes_init(0xFF);
+    reportar("i2c_sw","i2c_sw_lanes_init",0,bps,9,BENCHMARK_NA);
+    //Escritura de un byte distinto por canal: tx[8*k+n] es el byte k del canal n
+    iniciar();
+    i2c_sw_lanes_start();
+    reportar("i2c_sw","i2c_sw_lanes_start",0,bps,9,BENCHMARK_NA);
+    iniciar();
+    ack = i2c_sw_lanes_writeByteAll(0xA0);
+    reportar("i2c_sw","i2c_sw_lanes_writeByteAll",8,bps,9,ack == 0xFF);
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=8)
+        ack &= i2c_sw_lanes_writeByte(&tx[i]);
+    ok = (ack == 0xFF);
+    for(uint8_t canal=0;canal!=8;canal++) {
+        ok &= (i2c_sim[canal].num_rx == BENCHMARK_BYTES/8);
+        for(uint16_t k=0;k!=BENCHMARK_BYTES/8;k++)
+            ok &= (i2c_sim[canal].rx[k] == tx[8*k+canal]);
+    }
+    reportar("i2c_sw","i2c_sw_lanes_writeByte",BENCHMARK_BYTES,bps,9,ok);
+    //Lectura de un byte por canal después de RESTART
+    iniciar();
+    i2c_sw_lanes_restart();
+    reportar("i2c_sw","i2c_sw_lanes_restart",0,bps,9,BENCHMARK_NA);
+    ack = i2c_sw_lanes_writeByteAll(0xA1);
+    i2c_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=8)
+        i2c_sw_lanes_readByte(&rx[i],i != BENCHMARK_BYTES-8);
+    ok = (ack == 0xFF);
+    for(uint8_t canal=0;canal!=8;canal++) {
+        for(uint16_t k=0;k!=BENCHMARK_BYTES/8;k++)
+            ok &= (rx[8*k+canal] == patronCanal(k,canal));
+    }
+    reportar("i2c_sw","i2c_sw_lanes_readByte",BENCHMARK_BYTES,bps,9,ok);
+    iniciar();
+    i2c_sw_lanes_stop();
+    ok = 1;
+    for(uint8_t canal=0;canal!=8;canal++)
+        ok &= (i2c_sim[canal].estado == I2C_SIM_LIBRE);
+    reportar("i2c_sw","i2c_sw_lanes_stop",0,bps,9,ok && host_sim_getPines(HOST_SIM_PUERTO_D) == 0xFF);
+    host_sim_setCallback(NULL,NULL);
+}
+#endif
+
+#ifdef I2C_SW_ASYNC
+static uint8_t async_avisos;
+
+/**
+ * @brief Función de aviso de las transacciones en segundo plano: cuenta las transacciones terminadas
+ * @param transaccion (i2c_sw_transaccion_t *): Transacción terminada
+ * @return (void)
+*/
+static void async_aviso(i2c_sw_transaccion_t *transaccion) {
+    (void)transaccion;
+    async_avisos++;
+}
+
+/**
+ * @brief Función que encola una transacción y espera a que termine, midiendo desde el encolado
+ * @param transaccion (i2c_sw_transaccion_t *): Transacción a ejecutar
+ * @return (bool) true si se encoló, terminó sin error y se ejecutó su aviso
+*/
+static bool async_ejecutar(i2c_sw_transaccion_t *transaccion) {
+    bool encolada;
+    async_avisos = 0;
+    i2c_sim_reiniciar();
+    iniciar();
+    encolada = i2c_sw_async_encolar(transaccion);
+    while(i2c_sw_async_ocupado())
+        NOP();
+    return encolada && transaccion->terminada && transaccion->estado == I2C_SW_OK && async_avisos == 1;
+}
+
+static void benchmark_i2c_async(void) {
+    //Cada interrupción del motor avanza medio periodo de SCL
+    uint32_t bps = (_XTAL_FREQ/4)/(2UL*I2C_SW_ASYNC_CICLOS_TICK);
+    static const uint8_t registro = 0x00;
+    uint8_t escritura[BENCHMARK_BYTES+1], rx[BENCHMARK_BYTES];
+    i2c_sw_transaccion_t transaccion;
+    bool ok;
+    escritura[0] = registro;
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        escritura[i+1] = (uint8_t)(0xA5 ^ i);
+    reiniciar();
+    i2c_sim_configurar(HOST_SIM_PUERTO_B,0x01);
+    host_sim_setCallback(i2c_sim_flanco,NULL);
+    i2c_sw_init();
+    //Escritura del registro y los datos
+    memset(&transaccion,0,sizeof(transaccion));
+    transaccion.direccion = 0x50;
+    transaccion.escritura = escritura;
+    transaccion.len_escritura = BENCHMARK_BYTES+1;
+    transaccion.aviso = async_aviso;
+    ok = async_ejecutar(&transaccion);
+    reportar("i2c_sw","i2c_sw_async_encolar(escritura)",BENCHMARK_BYTES,bps,9,ok && i2c_sim[0].num_rx == BENCHMARK_BYTES+1 &&
+        !memcmp(i2c_sim[0].rx,escritura,BENCHMARK_BYTES+1));
+    //Lectura después del número de registro, con RESTART y con STOP y START
+    memset(rx,0,sizeof(rx));
+    transaccion.len_escritura = 1;
+    transaccion.lectura = rx;
+    transaccion.len_lectura = BENCHMARK_BYTES;
+    ok = async_ejecutar(&transaccion);
+    reportar("i2c_sw","i2c_sw_async_encolar(lectura)",BENCHMARK_BYTES,bps,9,ok && i2c_sim[0].num_rx == 1 && verificarPatron(rx,BENCHMARK_BYTES));
+    memset(rx,0,sizeof(rx));
+    transaccion.banderas = I2C_SW_ASYNC_STOP_START;
+    ok = async_ejecutar(&transaccion);
+    reportar("i2c_sw","i2c_sw_async_encolar(lectura STOP_START)",BENCHMARK_BYTES,bps,9,ok && i2c_sim[0].num_rx == 1 &&
+        verificarPatron(rx,BENCHMARK_BYTES));
+    host_sim_setCallback(NULL,NULL);
+}
+#endif
+
+#else
+/**
+ * Maestro i2c simulado para el modo esclavo (SDA en RB0, SCL en RB1): ejecuta una lista de pasos desde un temporizador, uno por
+ * interrupción, con tLOW de dos pasos y tHIGH de uno. Al liberar SCL espera a que suba (clock stretching del esclavo); los pasos
+ * de muestreo leen SDA y bajan SCL. INT0 e INT1 se emulan en la función de flancos: un flanco igual al seleccionado en
+ * INTEDG0/INTEDG1 activa la bandera, y el programa principal llama a i2c_sw_slave() mientras haya alguna habilitada.
+*/
+enum {MAESTRO_SDA, MAESTRO_SCL, MAESTRO_BIT, MAESTRO_ACK};
+#define MAESTRO_PASOS   ((BENCHMARK_BYTES+4)*27+16)
+static uint8_t maestro_pasos[MAESTRO_PASOS];       //(tipo<<1) | nivel
+static uint16_t maestro_num_pasos, maestro_paso;
+static uint8_t maestro_rx[BENCHMARK_BYTES], maestro_dato, maestro_bits;
+static uint16_t maestro_num_rx, maestro_nacks;
+static uint32_t maestro_periodo;
+static volatile uint8_t esclavo_registros[BENCHMARK_BYTES];
+
+#define ESCLAVO_PENDIENTE() ((INTCONbits.INT0IF && INTCONbits.INT0IE) || (INTCON3bits.INT1IF && INTCON3bits.INT1IE))
+
+/**
+ * @brief Función que agrega un paso a la lista del maestro simulado
+ * @param tipo (uint8_t): MAESTRO_x
+ * @param nivel (uint8_t): Nivel de la línea en MAESTRO_SDA y MAESTRO_SCL
+ * @return (void)
+*/
+static void maestro_agregar(uint8_t tipo, uint8_t nivel) {
+    if(maestro_num_pasos != MAESTRO_PASOS)
+        maestro_pasos[maestro_num_pasos++] = (tipo<<1) | nivel;
+}
+
+/**
+ * @brief Funciones que agregan al maestro simulado START (o START repetido con SCL en bajo), STOP, la escritura de un byte con
+ * muestreo del ACK y la lectura de un byte con ACK o NACK
+*/
+static void maestro_start(void) {
+    maestro_agregar(MAESTRO_SDA,1);
+    maestro_agregar(MAESTRO_SCL,1);
+    maestro_agregar(MAESTRO_SDA,0);
+    maestro_agregar(MAESTRO_SCL,0);
+}
+
+static void maestro_stop(void) {
+    maestro_agregar(MAESTRO_SDA,0);
+    maestro_agregar(MAESTRO_SCL,1);
+    maestro_agregar(MAESTRO_SDA,1);
+}
+
+static void maestro_write(uint8_t dato) {
+    for(uint8_t i=8;i;i--) {
+        maestro_agregar(MAESTRO_SDA,(dato>>(i-1)) & 0x01);
+        maestro_agregar(MAESTRO_SCL,1);
+        maestro_agregar(MAESTRO_SCL,0);
+    }
+    maestro_agregar(MAESTRO_SDA,1);
+    maestro_agregar(MAESTRO_SCL,1);
+    maestro_agregar(MAESTRO_ACK,0);
+}
+
+static void maestro_read(bool ack) {
+    for(uint8_t i=0;i!=8;i++) {
+        maestro_agregar(MAESTRO_SDA,1);
+        maestro_agregar(MAESTRO_SCL,1);
+        maestro_agregar(MAESTRO_BIT,0);
+    }
+    maestro_agregar(MAESTRO_SDA,!ack);
+    maestro_agregar(MAESTRO_SCL,1);
+    maestro_agregar(MAESTRO_SCL,0);
+}
+
+/**
+ * @brief Rutina del temporizador del maestro simulado: un paso por llamada
+ * @param (void)
+ * @return (void)
+*/
+static void maestro_isr(void) {
+    uint8_t paso, sda;
+    if(maestro_paso == maestro_num_pasos)
+        return;
+    paso = maestro_pasos[maestro_paso];
+    switch(paso>>1) {
+    case MAESTRO_SDA:
+        if(paso & 0x01)
+            host_sim_release(HOST_SIM_PUERTO_B,0x01);
+        else
+            host_sim_drive(HOST_SIM_PUERTO_B,0x01,0x00);
+        break;
+    case MAESTRO_SCL:
+        if(!(paso & 0x01)) {
+            host_sim_drive(HOST_SIM_PUERTO_B,0x02,0x00);
+            break;
+        }
+        host_sim_release(HOST_SIM_PUERTO_B,0x02);
+        if(!(host_sim_getPines(HOST_SIM_PUERTO_B) & 0x02))     //Clock stretching: se reintenta en la siguiente interrupción
+            return;
+        break;
+    default:
+        sda = host_sim_getPines(HOST_SIM_PUERTO_B) & 0x01;
+        if((paso>>1) == MAESTRO_ACK) {
+            if(sda)
+                maestro_nacks++;
+        } else {
+            maestro_dato = (maestro_dato<<1) | sda;
+            if(++maestro_bits == 8) {
+                if(maestro_num_rx != BENCHMARK_BYTES)
+                    maestro_rx[maestro_num_rx++] = maestro_dato;
+                maestro_bits = 0;
+            }
+        }
+        host_sim_drive(HOST_SIM_PUERTO_B,0x02,0x00);
+        break;
+    }
+    maestro_paso++;
+}
+
+/**
+ * @brief Función invocada por host_sim en cada flanco, que emula las interrupciones INT0 (SDA) e INT1 (SCL)
+ * @param flanco (const host_sim_flanco_t *): Flanco notificado
+ * @param contexto (void *): Sin uso
+ * @return (void)
+*/
+static void esclavo_flanco(const host_sim_flanco_t *flanco, void *contexto) {
+    (void)contexto;
+    if(flanco->puerto != HOST_SIM_PUERTO_B)
+        return;
+    if(flanco->pin == 0 && flanco->nivel == INTCON2bits.INTEDG0)
+        INTCONbits.INT0IF = 1;
+    else if(flanco->pin == 1 && flanco->nivel == INTCON2bits.INTEDG1)
+        INTCON3bits.INT1IF = 1;
+}
+
+/**
+ * @brief Función que ejecuta la lista de pasos del maestro simulado mientras atiende las interrupciones del esclavo, y la vacía
+ * @param (void)
+ * @return (bool) true si el maestro completó todos los pasos
+*/
+static bool maestro_ejecutar(void) {
+    uint64_t limite = host_sim_getCiclos() + 4UL*maestro_num_pasos*maestro_periodo;
+    bool completo;
+    maestro_paso = 0;
+    maestro_num_rx = 0;
+    maestro_nacks = 0;
+    maestro_bits = 0;
+    host_sim_setTimer(BENCHMARK_TIMER_EXTERNO,maestro_periodo,maestro_isr);
+    while(maestro_paso != maestro_num_pasos && host_sim_getCiclos() < limite) {
+        if(ESCLAVO_PENDIENTE()) {
+            _delay(BENCHMARK_LATENCIA);
+            i2c_sw_slave();
+        } else {
+            NOP();
+        }
+    }
+    host_sim_setTimer(BENCHMARK_TIMER_EXTERNO,0,NULL);
+    while(ESCLAVO_PENDIENTE())      //STOP
+        i2c_sw_slave();
+    completo = (maestro_paso == maestro_num_pasos);
+    maestro_num_pasos = 0;
+    return completo;
+}
+
+static void benchmark_i2c_esclavo(void) {
+    uint32_t bps;
+    uint8_t tx[BENCHMARK_BYTES];
+    bool ok;
+    //Un periodo de SCL del perfil I2C_SW_SPEED en tres pasos
+    maestro_periodo = (I2C_SW_CICLOS_NS(I2C_SW_T_LOW_NS + I2C_SW_T_HIGH_NS) + 2)/3;
+    bps = (_XTAL_FREQ/4)/(3*maestro_periodo);
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        tx[i] = (uint8_t)(0xA5 ^ i);
+    reiniciar();
+    host_sim_setCallback(esclavo_flanco,NULL);
+    iniciar();
+    i2c_sw_slave_init(0x50,esclavo_registros,BENCHMARK_BYTES);
+    reportar("i2c_sw","i2c_sw_slave_init",0,bps,9,BENCHMARK_NA);
+    //Escritura del mapa completo a partir del registro 0
+    maestro_start();
+    maestro_write(0xA0);
+    maestro_write(0x00);
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        maestro_write(tx[i]);
+    maestro_stop();
+    iniciar();
+    ok = maestro_ejecutar() && !maestro_nacks && !i2c_sw_slave_ocupado();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        ok &= (i2c_sw_slave_read(i) == tx[i]);
+    reportar("i2c_sw","i2c_sw_slave(escritura)",BENCHMARK_BYTES,bps,9,ok);
+    //Lectura del mapa con START repetido, cargado desde el programa
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        i2c_sw_slave_write(i,patron(i));
+    maestro_start();
+    maestro_write(0xA0);
+    maestro_write(0x00);
+    maestro_start();
+    maestro_write(0xA1);
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        maestro_read(i != BENCHMARK_BYTES-1);
+    maestro_stop();
+    iniciar();
+    ok = maestro_ejecutar() && !maestro_nacks && !i2c_sw_slave_ocupado();
+    reportar("i2c_sw","i2c_sw_slave(lectura)",BENCHMARK_BYTES,bps,9,ok && maestro_num_rx == BENCHMARK_BYTES && verificarPatron(maestro_rx,BENCHMARK_BYTES));
+    host_sim_setCallback(NULL,NULL);
+}
+#endif
+
+/**
+ * @brief Función que mide todas las funciones de spi_sw en un modo; el esclavo simulado debe estar conectado
+ * @param modo (uint8_t): Modo SPI
+ * @param primero (bool): true si es el primer modo medido (se inicia con spi_sw_init en lugar de spi_sw_setMode)
+ * @return (void)
+*/
+static void benchmark_spi_modo(uint8_t modo, bool primero) {
+    uint32_t bps;
+    uint8_t tx[BENCHMARK_BYTES], rx[BENCHMARK_BYTES], esperado[BENCHMARK_BYTES];
+    tipo_dato_tx_spi_sw dato_tx;
+    tipo_dato_rx_spi_sw dato_rx;
+    uint16_t valor16;
+    uint24_t valor24;
+    uint32_t valor32;
+    float flotante;
+    //spi_sw_write/read transfieren SPI_SW_NUM_BITS bits del MSB al LSB; sólo se verifican con un número entero de bytes
+    int verificar_tx = (SPI_SW_NUM_BITS_TX == 8*sizeof(tipo_dato_tx_spi_sw));
+    int verificar_rx = (SPI_SW_NUM_BITS_RX == 8*sizeof(tipo_dato_rx_spi_sw));
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++) {
+        tx[i] = (uint8_t)(0xA5 ^ i);
+        esperado[i] = patron(i);
+    }
+    //El cambio de modo mueve SCK a su nivel inactivo, por lo que el esclavo se reinicia después
+    modo_spi = modo;
+    spi_sim_cpol = modo>>1;
+    spi_sim_cpha = modo & 0x01;
+    iniciar();
+    if(primero)
+        spi_sw_init(modo);
+    else
+        spi_sw_setMode(modo);
+    reportar("spi_sw",primero? "spi_sw_init" : "spi_sw_setMode",0,spi_sw_getFrequency(),8,
+        spi_sw_getMode() == modo && ((host_sim_getLat(HOST_SIM_PUERTO_B)>>2) & 0x01) == spi_sim_cpol);
+    iniciar();
+    bps = spi_sw_getFrequency();
+    reportar("spi_sw","spi_sw_getFrequency",0,bps,8,bps == SPI_SW_SCK_HZ_REAL && (!SPI_SW_SCK_HZ || bps <= SPI_SW_SCK_HZ));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        spi_sw_writeByte(tx[i]);
+    reportar("spi_sw","spi_sw_writeByte",BENCHMARK_BYTES,bps,8,spi_sim_bytes == BENCHMARK_BYTES && !memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        rx[i] = spi_sw_readByte();
+    reportar("spi_sw","spi_sw_readByte",BENCHMARK_BYTES,bps,8,verificarPatron(rx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        rx[i] = spi_sw_xmit(tx[i]);
+    reportar("spi_sw","spi_sw_xmit",BENCHMARK_BYTES,bps,8,verificarPatron(rx,BENCHMARK_BYTES) && !memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(dato_tx)) {
+        dato_tx = 0;
+        for(uint8_t j=0;j!=sizeof(dato_tx);j++)
+            dato_tx = (dato_tx<<8) | tx[i+j];
+        spi_sw_write(dato_tx);
+    }
+    reportar("spi_sw","spi_sw_write",BENCHMARK_BYTES,bps,8,verificar_tx? !memcmp(spi_sim_rx,tx,BENCHMARK_BYTES) : BENCHMARK_NA);
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(dato_rx)) {
+        dato_rx = spi_sw_read();
+        for(uint8_t j=sizeof(dato_rx);j;j--) {
+            rx[i+j-1] = (uint8_t)dato_rx;
+            dato_rx >>= 8;
+        }
+    }
+    reportar("spi_sw","spi_sw_read",BENCHMARK_BYTES,bps,8,verificar_rx? verificarPatron(rx,BENCHMARK_BYTES) : BENCHMARK_NA);
+    spi_sim_reiniciar();
+    iniciar();
+    spi_sw_transfer(tx,rx,BENCHMARK_BYTES);
+    reportar("spi_sw","spi_sw_transfer",BENCHMARK_BYTES,bps,8,verificarPatron(rx,BENCHMARK_BYTES) && !memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    spi_sw_writeBuffer(tx,BENCHMARK_BYTES);
+    reportar("spi_sw","spi_sw_writeBuffer",BENCHMARK_BYTES,bps,8,spi_sim_bytes == BENCHMARK_BYTES && !memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    spi_sw_readBuffer(rx,BENCHMARK_BYTES);
+    reportar("spi_sw","spi_sw_readBuffer",BENCHMARK_BYTES,bps,8,verificarPatron(rx,BENCHMARK_BYTES));
+    //Enteros y flotantes: se transfieren en el orden de los bytes en memoria
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor16)) {
+        memcpy(&valor16,&tx[i],sizeof(valor16));
+        spi_sw_writeInt16(valor16);
+    }
+    reportar("spi_sw","spi_sw_writeInt16",BENCHMARK_BYTES,bps,8,!memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor24)) {
+        memcpy(&valor24,&tx[i],sizeof(valor24));
+        spi_sw_writeInt24(valor24);
+    }
+    reportar("spi_sw","spi_sw_writeInt24",BENCHMARK_BYTES,bps,8,!memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor32)) {
+        memcpy(&valor32,&tx[i],sizeof(valor32));
+        spi_sw_writeInt32(valor32);
+    }
+    reportar("spi_sw","spi_sw_writeInt32",BENCHMARK_BYTES,bps,8,!memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(flotante)) {
+        memcpy(&flotante,&tx[i],sizeof(flotante));
+        spi_sw_writeFloat(flotante);
+    }
+    reportar("spi_sw","spi_sw_writeFloat",BENCHMARK_BYTES,bps,8,!memcmp(spi_sim_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor16)) {
+        valor16 = spi_sw_readInt16();
+        memcpy(&rx[i],&valor16,sizeof(valor16));
+    }
+    reportar("spi_sw","spi_sw_readInt16",BENCHMARK_BYTES,bps,8,!memcmp(rx,esperado,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor24)) {
+        valor24 = spi_sw_readInt24();
+        memcpy(&rx[i],&valor24,sizeof(valor24));
+    }
+    reportar("spi_sw","spi_sw_readInt24",BENCHMARK_BYTES,bps,8,!memcmp(rx,esperado,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(valor32)) {
+        valor32 = spi_sw_readInt32();
+        memcpy(&rx[i],&valor32,sizeof(valor32));
+    }
+    reportar("spi_sw","spi_sw_readInt32",BENCHMARK_BYTES,bps,8,!memcmp(rx,esperado,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=sizeof(flotante)) {
+        flotante = spi_sw_readFloat();
+        memcpy(&rx[i],&flotante,sizeof(flotante));
+    }
+    reportar("spi_sw","spi_sw_readFloat",BENCHMARK_BYTES,bps,8,!memcmp(rx,esperado,BENCHMARK_BYTES));
+#ifdef SPI_SW_LANES
+    //Multicanal: tx[8*k+n] es el byte k del canal n
+    if(primero) {
+        iniciar();
+        spi_sw_lanes_init(0xFF);
+        reportar("spi_sw","spi_sw_lanes_init",0,8*bps,8,host_sim_getTris(HOST_SIM_PUERTO_D) == 0x00);
+    }
+    spi_sim_reiniciar();
+    iniciar();
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=8)
+        spi_sw_lanes_writeByte(&tx[i]);
+    reportar("spi_sw","spi_sw_lanes_writeByte",BENCHMARK_BYTES,8*bps,8,!memcmp(spi_sim_canales_rx,tx,BENCHMARK_BYTES));
+    spi_sim_reiniciar();
+    iniciar();
+    spi_sw_lanes_write(tx,BENCHMARK_BYTES/8);
+    reportar("spi_sw","spi_sw_lanes_write",BENCHMARK_BYTES,8*bps,8,!memcmp(spi_sim_canales_rx,tx,BENCHMARK_BYTES));
+#endif
+}
+
+static void benchmark_spi(void) {
+    bool primero = true;
+    reiniciar();
+    host_sim_setCallback(spi_sim_flanco,NULL);
+    for(uint8_t modo=0;modo!=4;modo++) {
+#ifdef SPI_SW_FIXED_MODE
+        if(modo != SPI_SW_FIXED_MODE)
+            continue;
+#else
+        if(!(SPI_SW_MODES & (1<<modo)))
+            continue;
+#endif
+        benchmark_spi_modo(modo,primero);
+        primero = false;
+    }
+    modo_spi = BENCHMARK_NA;
+    host_sim_setCallback(NULL,NULL);
+}
+
+#ifdef SERIAL_SW_RX_ISR
+/**
+ * @brief Función que espera a que la recepción en segundo plano tenga n bytes disponibles, con el tiempo límite de las lecturas
+ * @param n (uint16_t): Bytes requeridos
+ * @return (bool) true si están disponibles, false si se agotó el tiempo
+*/
+static bool esperarRX(uint16_t n) {
+    uint64_t limite = host_sim_getCiclos() + BENCHMARK_TIMEOUT;
+    while(serial_sw_available() < n) {
+        if(host_sim_getCiclos() >= limite)
+            return false;
+        NOP();
+    }
+    return true;
+}
+#endif
+
+/**
+ * Funciones de transmisión y recepción de serial_sw medidas con los mismos datos. Cada una transfiere len bytes (múltiplo del
+ * tamaño de su tipo) en el orden en que se encuentran en memoria; las de recepción devuelven false si alguna lectura falló.
+*/
+#define SERIAL_TX_TIPO(funcion,tipo) \
+static void tx_##funcion(const uint8_t *datos, uint16_t len) { \
+    tipo valor; \
+    for(uint16_t i=0;i!=len;i+=sizeof(tipo)) { \
+        memcpy(&valor,&datos[i],sizeof(tipo)); \
+        serial_sw_##funcion(valor); \
+    } \
+}
+#define SERIAL_RX_TIPO(funcion,tipo) \
+static bool rx_##funcion(uint8_t *datos, uint16_t len) { \
+    tipo valor; \
+    for(uint16_t i=0;i!=len;i+=sizeof(tipo)) { \
+        ESPERAR_RX(sizeof(tipo)) \
+        valor = serial_sw_##funcion(); \
+        memcpy(&datos[i],&valor,sizeof(tipo)); \
+    } \
+    return true; \
+}
+#define SERIAL_RX_TIMEOUT(funcion,tipo) \
+static bool rx_##funcion(uint8_t *datos, uint16_t len) { \
+    tipo valor; \
+    for(uint16_t i=0;i!=len;i+=sizeof(tipo)) { \
+        if(serial_sw_##funcion(&valor,BENCHMARK_TIMEOUT) != SERIAL_SW_OK) \
+            return false; \
+        memcpy(&datos[i],&valor,sizeof(tipo)); \
+    } \
+    return true; \
+}
+
+SERIAL_TX_TIPO(writeByte,uint8_t)
+SERIAL_TX_TIPO(writeInt16,uint16_t)
+SERIAL_TX_TIPO(writeInt24,uint24_t)
+SERIAL_TX_TIPO(writeInt32,uint32_t)
+SERIAL_TX_TIPO(writeFloat,float)
+SERIAL_RX_TIPO(readByte,uint8_t)
+SERIAL_RX_TIPO(readInt16,uint16_t)
+SERIAL_RX_TIPO(readInt24,uint24_t)
+SERIAL_RX_TIPO(readInt32,uint32_t)
+SERIAL_RX_TIPO(readFloat,float)
+SERIAL_RX_TIMEOUT(readByteTimeout,uint8_t)
+SERIAL_RX_TIMEOUT(readInt16Timeout,uint16_t)
+SERIAL_RX_TIMEOUT(readInt24Timeout,uint24_t)
+SERIAL_RX_TIMEOUT(readInt32Timeout,uint32_t)
+SERIAL_RX_TIMEOUT(readFloatTimeout,float)
+
+static void tx_write(const uint8_t *datos, uint16_t len) {
+    serial_sw_write((void *)datos,len);
+}
+
+//Con recepción en segundo plano read y gets se llaman por bloques, cada uno una vez que está disponible completo
+static bool rx_read(uint8_t *datos, uint16_t len) {
+#ifdef SERIAL_SW_RX_ISR
+    for(uint16_t i=0,n;i!=len;i+=n) {
+        n = (len-i < BENCHMARK_BLOQUE)? len-i : BENCHMARK_BLOQUE;
+        ESPERAR_RX(n)
+        if(serial_sw_read(datos+i,n) != n)
+            return false;
+    }
+    return true;
+#else
+    return serial_sw_read(datos,len) == len;
+#endif
+}
+
+static bool rx_gets(uint8_t *datos, uint16_t len) {
+#ifdef SERIAL_SW_RX_ISR
+    for(uint16_t i=0,n;i!=len;i+=n) {
+        n = (len-i < BENCHMARK_BLOQUE)? len-i : BENCHMARK_BLOQUE;
+        ESPERAR_RX(n)
+        if(serial_sw_gets(datos+i,n) != n)
+            return false;
+    }
+    return true;
+#else
+    return serial_sw_gets(datos,len) == len;
+#endif
+}
+
+static bool rx_readTimeout(uint8_t *datos, uint16_t len) {
+    uint16_t recibidos;
+    return serial_sw_readTimeout(datos,len,&recibidos,BENCHMARK_TIMEOUT) == SERIAL_SW_OK && recibidos == len;
+}
+
+static bool rx_getsTimeout(uint8_t *datos, uint16_t len) {
+    uint16_t recibidos;
+    return serial_sw_getsTimeout(datos,len,&recibidos,BENCHMARK_TIMEOUT) == SERIAL_SW_OK && recibidos == len;
+}
+
+static bool rx_pollByte(uint8_t *datos, uint16_t len) {
+    serial_sw_estado_t estado;
+    for(uint16_t i=0;i!=len;i++) {
+        while((estado = serial_sw_pollByte(&datos[i])) == SERIAL_SW_VACIO) {
+            ESPERAR_RX(1)
+        }
+        if(estado != SERIAL_SW_OK)
+            return false;
+    }
+    return true;
+}
+
+static const struct {
+    const char *nombre;
+    void (*funcion)(const uint8_t *datos, uint16_t len);
+} serial_tx[] = {
+    {"serial_sw_writeByte",tx_writeByte}, {"serial_sw_write",tx_write}, {"serial_sw_writeInt16",tx_writeInt16},
+    {"serial_sw_writeInt24",tx_writeInt24}, {"serial_sw_writeInt32",tx_writeInt32}, {"serial_sw_writeFloat",tx_writeFloat}
+};
+
+static const struct {
+    const char *nombre;
+    bool (*funcion)(uint8_t *datos, uint16_t len);
+} serial_rx[] = {
+    {"serial_sw_readByte",rx_readByte}, {"serial_sw_read",rx_read}, {"serial_sw_gets",rx_gets},
+    {"serial_sw_readInt16",rx_readInt16}, {"serial_sw_readInt24",rx_readInt24}, {"serial_sw_readInt32",rx_readInt32},
+    {"serial_sw_readFloat",rx_readFloat}, {"serial_sw_pollByte",rx_pollByte}, {"serial_sw_readByteTimeout",rx_readByteTimeout},
+    {"serial_sw_readTimeout",rx_readTimeout}, {"serial_sw_getsTimeout",rx_getsTimeout},
+    {"serial_sw_readInt16Timeout",rx_readInt16Timeout}, {"serial_sw_readInt24Timeout",rx_readInt24Timeout},
+    {"serial_sw_readInt32Timeout",rx_readInt32Timeout}, {"serial_sw_readFloatTimeout",rx_readFloatTimeout}
+};
+
+#ifdef SERIAL_SW_TX_LANES
+/**
+ * @brief Función que verifica con el grabador las tramas de cada canal TX del puerto D
+ * @param cadenas (const char **): Cadena esperada de cada canal, o NULL para usar bytes
+ * @param bytes (const uint8_t *): Datos esperados si cadenas es NULL: bytes[8*k+n] es el byte k del canal n
+ * @param len (uint16_t): Bytes por canal si cadenas es NULL
+ * @return (int) 1 si todos los canales coinciden, 0 en caso contrario
+*/
+static int verificarCanalesUART(const char **cadenas, const uint8_t *bytes, uint16_t len) {
+    uint8_t esperado[BENCHMARK_BYTES];
+    int ok = 1;
+    for(uint8_t canal=0;canal!=8;canal++) {
+        if(cadenas) {
+            len = (uint16_t)strlen(cadenas[canal]);
+            memcpy(esperado,cadenas[canal],len);
+        } else {
+            for(uint16_t k=0;k!=len;k++)
+                esperado[k] = bytes[8*k+canal];
+        }
+        ok &= verificarUART(HOST_SIM_PUERTO_D,canal,CYCLES_BIT_PERIOD,esperado,len);
+    }
+    return ok;
+}
+#endif
+
+#ifdef SERIAL_SW_BAUD_VARIABLE
+/**
+ * @brief Función que mide la transmisión y recepción en cada velocidad de la tabla de serial_sw_setBaud(), y la detección
+ * automática con serial_sw_autobaud() partiendo de SW_BAUDRATE
+ * @param datos (const uint8_t *): BENCHMARK_BYTES bytes de prueba
+ * @return (void)
+*/
+static void benchmark_serial_baud(const uint8_t *datos) {
+    static const uint32_t velocidades[] = {1200UL, 2400UL, 4800UL, 9600UL, 14400UL, 19200UL, 38400UL, 57600UL, 115200UL};
+    uint8_t rx[BENCHMARK_BYTES], sincronia[BENCHMARK_BYTES+1];
+    uint32_t baud;
+    bool ok;
+    sincronia[0] = 0x55;
+    memcpy(sincronia+1,datos,BENCHMARK_BYTES);
+    for(size_t v=0;v!=NUM_ELEMENTOS(velocidades);v++) {
+        baud = velocidades[v];
+        iniciar();
+        ok = serial_sw_setBaud(baud);
+        if(!ok)                     //Velocidad fuera de la tabla para este cristal
+            continue;
+        reportar("serial_sw","serial_sw_setBaud",0,baud,10,serial_sw_getBaud() == baud);
+        tx_sim_periodo = (((2*(_XTAL_FREQ/4))/baud)+1)/2;
+        host_sim_grabador_iniciar(_XTAL_FREQ);
+        iniciar();
+        tx_writeByte(datos,BENCHMARK_BYTES);
+        reportar("serial_sw","serial_sw_writeByte",BENCHMARK_BYTES,baud,10,verificarUART(HOST_SIM_PUERTO_B,6,tx_sim_periodo,datos,BENCHMARK_BYTES));
+        host_sim_grabador_detener();
+        memset(rx,0,sizeof(rx));
+        tx_sim_enviar(datos,BENCHMARK_BYTES,0);
+        iniciar();
+        ok = rx_readByte(rx,BENCHMARK_BYTES);
+        reportar("serial_sw","serial_sw_readByte",BENCHMARK_BYTES,baud,10,ok && !memcmp(rx,datos,BENCHMARK_BYTES));
+        tx_sim_esperar();
+        //Detección automática desde la velocidad inicial: carácter de sincronía seguido de los datos
+        serial_sw_setBaud(SW_BAUDRATE);
+        memset(rx,0,sizeof(rx));
+        tx_sim_enviar(sincronia,sizeof(sincronia),0);
+        iniciar();
+        ok = serial_sw_autobaud(0x55);
+        reportar("serial_sw","serial_sw_autobaud",0,baud,10,ok && SERIAL_SW_DIF(serial_sw_getBaud(),baud)*10000UL <= SERIAL_SW_TOLERANCIA*baud);
+        iniciar();
+        ok = rx_readByte(rx,BENCHMARK_BYTES);
+        reportar("serial_sw","serial_sw_readByte(autobaud)",BENCHMARK_BYTES,baud,10,ok && !memcmp(rx,datos,BENCHMARK_BYTES));
+        tx_sim_esperar();
+    }
+    serial_sw_setBaud(SW_BAUDRATE);
+    tx_sim_periodo = CYCLES_BIT_PERIOD;
+}
+#endif
+
+static void benchmark_serial(void) {
+    static const char cadena[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz+-";
+    static const char linea[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz+-\r\n";
+    uint8_t datos[BENCHMARK_BYTES], rx[BENCHMARK_BYTES];
+    int ok;
+    for(uint16_t i=0;i!=BENCHMARK_BYTES;i++)
+        datos[i] = (uint8_t)(0xA5 ^ i);
+    reiniciar();
+    iniciar();
+    serial_sw_init();
+    reportar("serial_sw","serial_sw_init",0,SW_BAUDRATE,10,BENCHMARK_NA);
+    //Interrupciones de los motores en segundo plano
+#if defined(SERIAL_SW_FULL_DUPLEX)
+    host_sim_setTimer(BENCHMARK_TIMER_TX,CYCLES_FD_TICK_PERIOD,serial_sw_fd_isr);
+#elif defined(SERIAL_SW_TX_ISR)
+    host_sim_setTimer(BENCHMARK_TIMER_TX,CYCLES_BIT_PERIOD,serial_sw_tx_isr);
+#endif
+#if defined(SERIAL_SW_RX_ISR) && !defined(SERIAL_SW_FULL_DUPLEX)
+    host_sim_setCallback(rx_flanco,NULL);
+#endif
+    //Transmisión: cada medición se graba por separado para verificar las tramas
+    for(size_t f=0;f!=NUM_ELEMENTOS(serial_tx);f++) {
+        host_sim_grabador_iniciar(_XTAL_FREQ);
+        iniciar();
+        serial_tx[f].funcion(datos,BENCHMARK_BYTES);
+        ESPERAR_TX();
+        reportar("serial_sw",serial_tx[f].nombre,BENCHMARK_BYTES,SW_BAUDRATE,10,verificarUART(HOST_SIM_PUERTO_B,6,CYCLES_BIT_PERIOD,datos,BENCHMARK_BYTES));
+    }
+    host_sim_grabador_iniciar(_XTAL_FREQ);
+    iniciar();
+    serial_sw_puts(cadena);
+    ESPERAR_TX();
+    reportar("serial_sw","serial_sw_puts",sizeof(cadena)-1,SW_BAUDRATE,10,verificarUART(HOST_SIM_PUERTO_B,6,CYCLES_BIT_PERIOD,(const uint8_t *)cadena,sizeof(cadena)-1));
+    host_sim_grabador_iniciar(_XTAL_FREQ);
+    iniciar();
+    serial_sw_writeLine(cadena);
+    ESPERAR_TX();
+    reportar("serial_sw","serial_sw_writeLine",sizeof(linea)-1,SW_BAUDRATE,10,verificarUART(HOST_SIM_PUERTO_B,6,CYCLES_BIT_PERIOD,(const uint8_t *)linea,sizeof(linea)-1));
+#ifdef SERIAL_SW_TX_ISR
+    iniciar();
+    ok = (serial_sw_txPending() == 0);
+    reportar("serial_sw","serial_sw_txPending",0,SW_BAUDRATE,10,ok);
+    host_sim_grabador_iniciar(_XTAL_FREQ);
+    iniciar();
+    tx_writeByte(datos,BENCHMARK_BYTES);
+    serial_sw_flush();
+    reportar("serial_sw","serial_sw_flush",BENCHMARK_BYTES,SW_BAUDRATE,10,serial_sw_txPending() == 0 &&
+        verificarUART(HOST_SIM_PUERTO_B,6,CYCLES_BIT_PERIOD,datos,BENCHMARK_BYTES));
+#endif
+    host_sim_grabador_detener();
+    //Recepción desde el transmisor simulado
+    for(size_t f=0;f!=NUM_ELEMENTOS(serial_rx);f++) {
+        memset(rx,0,sizeof(rx));
+        tx_sim_enviar(datos,BENCHMARK_BYTES,0);
+        iniciar();
+        ok = serial_rx[f].funcion(rx,BENCHMARK_BYTES) && !memcmp(rx,datos,BENCHMARK_BYTES);
+        reportar("serial_sw",serial_rx[f].nombre,BENCHMARK_BYTES,SW_BAUDRATE,10,ok);
+        tx_sim_esperar();
+#ifdef SERIAL_SW_RX_ISR
+        while(serial_sw_available())
+            serial_sw_readByte();
+#endif
+    }
+#ifdef SERIAL_SW_RX_ISR
+    tx_sim_enviar(datos,BENCHMARK_BYTES/4,0);
+    tx_sim_esperar();
+    iniciar();
+    ok = (serial_sw_available() == BENCHMARK_BYTES/4);
+    reportar("serial_sw","serial_sw_available",0,SW_BAUDRATE,10,ok && rx_read(rx,BENCHMARK_BYTES/4) && !memcmp(rx,datos,BENCHMARK_BYTES/4));
+#endif
+#ifdef SERIAL_SW_FULL_DUPLEX
+    //Transmisión y recepción simultáneas: se escribe sin llenar el buffer de transmisión y se lee lo disponible
+    {
+        uint64_t limite = host_sim_getCiclos() + BENCHMARK_TIMEOUT;
+        memset(rx,0,sizeof(rx));
+        host_sim_grabador_iniciar(_XTAL_FREQ);
+        tx_sim_enviar(datos,BENCHMARK_BYTES,0);
+        iniciar();
+        for(uint16_t enviados=0,recibidos=0;(enviados != BENCHMARK_BYTES || recibidos != BENCHMARK_BYTES) && host_sim_getCiclos() < limite;) {
+            if(enviados != BENCHMARK_BYTES && serial_sw_txPending() < SERIAL_SW_TX_BUFFER_SIZE-1)
+                serial_sw_writeByte(datos[enviados++]);
+            recibidos += serial_sw_read(rx+recibidos,BENCHMARK_BYTES-recibidos);
+            NOP();
+        }
+        serial_sw_flush();
+    }
+    reportar("serial_sw","serial_sw_fd_isr(writeByte+read)",2*BENCHMARK_BYTES,2*SW_BAUDRATE,10,!memcmp(rx,datos,BENCHMARK_BYTES) &&
+        verificarUART(HOST_SIM_PUERTO_B,6,CYCLES_BIT_PERIOD,datos,BENCHMARK_BYTES));
+    host_sim_grabador_detener();
+    tx_sim_esperar();
+#endif
+#ifdef SERIAL_SW_VALIDAR_STOP
+    {
+        //Tramas: válida, con STOP en bajo, break y válida; sólo se entregan las válidas y se cuentan las demás
+        static const uint8_t tramas[4] = {0x5A, 0x33, 0x00, 0xA5};
+        uint16_t recibidos = 0;
+        serial_sw_clearErrores();
+        tx_sim_enviar(tramas,sizeof(tramas),0x06);
+        iniciar();
+        ok = (serial_sw_readTimeout(rx,2,&recibidos,BENCHMARK_TIMEOUT) == SERIAL_SW_OK && recibidos == 2 && rx[0] == tramas[0] && rx[1] == tramas[3]);
+        reportar("serial_sw","serial_sw_readTimeout(STOP invalido)",2,SW_BAUDRATE,10,ok);
+        tx_sim_esperar();
+        iniciar();
+        ok = (serial_sw_getErroresTrama() == 1);
+        reportar("serial_sw","serial_sw_getErroresTrama",0,SW_BAUDRATE,10,ok);
+        iniciar();
+        ok = (serial_sw_getBreaks() == 1);
+        reportar("serial_sw","serial_sw_getBreaks",0,SW_BAUDRATE,10,ok);
+        iniciar();
+        serial_sw_clearErrores();
+        reportar("serial_sw","serial_sw_clearErrores",0,SW_BAUDRATE,10,!serial_sw_getErroresTrama() && !serial_sw_getBreaks());
+    }
+#endif
+#ifdef SERIAL_SW_TX_LANES
+    {
+        static const char *cadenas[8] = {"canal 0", "c1", "canal dos", "", "canal cuatro", "5", "canal seis de ocho", "siete"};
+        uint32_t bytes = 0;
+        for(uint8_t canal=0;canal!=8;canal++)
+            bytes += (uint32_t)strlen(cadenas[canal]);
+        iniciar();
+        serial_sw_lanes_init(0xFF);
+        reportar("serial_sw","serial_sw_lanes_init",0,8*SW_BAUDRATE,10,host_sim_getTris(HOST_SIM_PUERTO_D) == 0x00);
+        host_sim_grabador_iniciar(_XTAL_FREQ);
+        iniciar();
+        for(uint16_t i=0;i!=BENCHMARK_BYTES;i+=8)
+            serial_sw_lanes_writeByte(&datos[i]);
+        reportar("serial_sw","serial_sw_lanes_writeByte",BENCHMARK_BYTES,8*SW_BAUDRATE,10,verificarCanalesUART(NULL,datos,BENCHMARK_BYTES/8));
+        host_sim_grabador_iniciar(_XTAL_FREQ);
+        iniciar();
+        serial_sw_lanes_puts(cadenas);
+        reportar("serial_sw","serial_sw_lanes_puts",bytes,8*SW_BAUDRATE,10,verificarCanalesUART(cadenas,NULL,0));
+        host_sim_grabador_detener();
+    }
+#endif
+#ifdef SERIAL_SW_BAUD_VARIABLE
+    benchmark_serial_baud(datos);
+#endif
+    host_sim_setTimer(BENCHMARK_TIMER_TX,0,NULL);
+    host_sim_setCallback(NULL,NULL);
+}
+
+int main(int argc, char **argv) {
+    bool encabezado = true;
+    for(int i=1;i<argc;i++) {
+        if(!strcmp(argv[i],"-s"))
+            encabezado = false;
+        else
+            costo = (uint8_t)atoi(argv[i]);
+    }
+    if(encabezado)
+        printf("xtal_hz,costo_acceso,variante,driver,modo,funcion,bytes,ciclos,ciclos_por_byte,bps_efectivos,bps_linea,bps_teoricos,sobrecosto_pct,verificado\n");
+#ifdef SLAVE_MODE_SW
+    benchmark_i2c_esclavo();
+#else
+    benchmark_i2c();
+#ifdef I2C_SW_LANES
+    benchmark_i2c_lanes();
+#endif
+#ifdef I2C_SW_ASYNC
+    benchmark_i2c_async();
+#endif
+#endif
+    benchmark_spi();
+    benchmark_serial();
+    return 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file host_sim_benchmark.h
+ * @brief Sustitución de las macros de control de interrupciones de i2c_sw y serial_sw por temporizadores de host_sim, para medir
+ * los motores en segundo plano con host_sim_benchmark.c. Debe incluirse antes que los encabezados de los controladores en todas
+ * las unidades de compilación (gcc -include HOST_SIM/host_sim_benchmark.h), como lo hace host_sim_benchmark.sh.
+ * El modo esclavo de i2c_sw conserva sus macros por defecto: host_sim_benchmark.c emula INT0/INT1 sobre INTCON, INTCON2 e INTCON3.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#ifndef HOST_SIM_BENCHMARK_H
+#define	HOST_SIM_BENCHMARK_H
+
+#include <stdint.h>
+#include "host_sim.h"
+
+/**
+ * Temporizadores simulados utilizados por el benchmark
+*/
+#define BENCHMARK_TIMER_EXTERNO     0   //Dispositivos simulados: transmisor UART y maestro i2c
+#define BENCHMARK_TIMER_TX          1   //serial_sw_tx_isr() o serial_sw_fd_isr()
+#define BENCHMARK_TIMER_TMR1        2   //TMR1: recepción en segundo plano de serial_sw y motor de i2c_sw_async (no se usan a la vez)
+#define BENCHMARK_TIMER_FLANCO      3   //Interrupción por flanco de SW_RX
+
+/**
+ * Prototipos de funciones (host_sim_benchmark.c)
+*/
+void benchmark_tmr1_iniciar(uint32_t ciclos, host_sim_isr_t isr);
+void benchmark_tmr1_recargar(uint32_t ciclos);
+void benchmark_tmr1_detener(void);
+void benchmark_rx_flanco(uint8_t habilitar);
+
+/**
+ * TMR1 se sustituye por BENCHMARK_TIMER_TMR1. La recarga se cuenta desde el vencimiento anterior, como TMR1 += recarga, para no
+ * acumular la latencia de la interrupción.
+*/
+#define I2C_SW_ASYNC_TIMER_INICIAR(ciclos)  {benchmark_tmr1_iniciar((ciclos),i2c_sw_async_isr);}
+#define I2C_SW_ASYNC_TIMER_RECARGAR(ciclos) {benchmark_tmr1_recargar(ciclos);}
+#define I2C_SW_ASYNC_TIMER_DETENER()        {benchmark_tmr1_detener();}
+
+#define SERIAL_SW_RX_TIMER_INICIAR(ciclos)  {benchmark_tmr1_iniciar((ciclos),serial_sw_rx_timer_isr);}
+#define SERIAL_SW_RX_TIMER_RECARGAR(ciclos) {benchmark_tmr1_recargar(ciclos);}
+#define SERIAL_SW_RX_TIMER_DETENER()        {benchmark_tmr1_detener();}
+#define SERIAL_SW_RX_FLANCO_HABILITAR()     {benchmark_rx_flanco(1);}
+#define SERIAL_SW_RX_FLANCO_DESHABILITAR()  {benchmark_rx_flanco(0);}
+
+#endif	/* HOST_SIM_BENCHMARK_H */
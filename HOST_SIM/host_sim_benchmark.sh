@@ -0,0 +1,61 @@
+#!/bin/sh
+# Compila host_sim_benchmark.c para varios _XTAL_FREQ y variantes de opciones de los controladores, y genera un solo CSV con
+# todas las mediciones (columnas variante y modo).
+# Uso (desde la raíz del repositorio o desde HOST_SIM):
+#   sh HOST_SIM/host_sim_benchmark.sh [costo_acceso] [archivo.csv] [frecuencias...]
+# Por defecto: costo 13 (serial_sw calibrado), salida a stdout, 8, 16, 32 y 64 MHz, todas las variantes.
+# Variables de entorno: CC (gcc por defecto), CFLAGS (-O2 -Wall -Wextra por defecto) y VARIANTES (nombres separados por espacios).
+
+set -e
+
+RAIZ=$(cd "$(dirname "$0")/.." && pwd)
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2 -Wall -Wextra}
+COSTO=${1:-13}
+SALIDA=${2:--}
+[ $# -gt 2 ] && shift 2 || set -- 8000000 16000000 32000000 64000000
+VARIANTES=${VARIANTES:-base spi_fijo i2c_fast i2c_fast_plus lanes isr full_duplex esclavo mayoria fraccional baud_variable}
+
+# Opciones de compilación de cada variante. En host_sim los lazos de espera con NOP() cuestan un ciclo por iteración, y los de
+# la velocidad variable un acceso a registro (COSTO) por bit o por iteración; los ciclos de las esperas se calibran con ello.
+opciones() {
+    case "$1" in
+        base)           echo "" ;;
+        spi_fijo)       echo "-DSPI_SW_FIXED_MODE=3 -DSPI_SW_SCK_HZ=400000" ;;
+        i2c_fast)       echo "-DI2C_SW_SPEED=1 -DI2C_SW_MULTI_MAESTRO" ;;
+        i2c_fast_plus)  echo "-DI2C_SW_SPEED=2" ;;
+        lanes)          echo "-DI2C_SW_LANES -DSPI_SW_LANES -DSERIAL_SW_TX_LANES" ;;
+        isr)            echo "-DI2C_SW_ASYNC -DSERIAL_SW_TX_ISR -DSERIAL_SW_RX_ISR -DSERIAL_SW_VALIDAR_STOP -DSERIAL_SW_CICLOS_ESPERA=1" ;;
+        full_duplex)    echo "-DSERIAL_SW_FULL_DUPLEX -DSERIAL_SW_VALIDAR_STOP -DSERIAL_SW_CICLOS_ESPERA=1" ;;
+        esclavo)        echo "-DSLAVE_MODE_SW" ;;
+        mayoria)        echo "-DSERIAL_SW_RX_MAYORIA -DSERIAL_SW_VALIDAR_STOP" ;;
+        fraccional)     echo "-DSERIAL_SW_BIT_FRACCIONAL" ;;
+        baud_variable)  echo "-DSERIAL_SW_BAUD_VARIABLE -DSERIAL_SW_VALIDAR_STOP -DSERIAL_SW_CICLOS_LAZO=0" \
+                             "-DSERIAL_SW_CORRECCION_TX_BIT=$COSTO -DSERIAL_SW_CORRECCION_RX_BIT=$COSTO" \
+                             "-DSERIAL_SW_CORRECCION_RX_INICIO=$((COSTO*3/2)) -DSERIAL_SW_CICLOS_ESPERA=$COSTO" \
+                             "-DSERIAL_SW_CICLOS_MEDICION=$COSTO" ;;
+        *)              echo "Variante desconocida: $1" >&2; exit 1 ;;
+    esac
+}
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT INT TERM
+
+ENCABEZADO=
+for VARIANTE in $VARIANTES; do
+    OPCIONES=$(opciones "$VARIANTE")
+    for XTAL in "$@"; do
+        $CC $CFLAGS -D_XTAL_FREQ=${XTAL}UL -DBENCHMARK_VARIANTE=\"$VARIANTE\" $OPCIONES -I "$RAIZ/HOST_SIM" \
+            -include "$RAIZ/HOST_SIM/host_sim_benchmark.h" -o "$TMP/benchmark_${VARIANTE}_$XTAL" \
+            "$RAIZ/HOST_SIM/host_sim_benchmark.c" "$RAIZ/HOST_SIM/host_sim.c" "$RAIZ/HOST_SIM/host_sim_grabador.c" \
+            "$RAIZ/I2C_SW/i2c_sw.c" "$RAIZ/SPI_SW/spi_sw.c" "$RAIZ/SERIAL_SW/serial_sw.c"
+        "$TMP/benchmark_${VARIANTE}_$XTAL" "$COSTO" $ENCABEZADO >> "$TMP/resultados.csv"
+        ENCABEZADO=-s
+    done
+done
+
+if [ "$SALIDA" = "-" ]; then
+    cat "$TMP/resultados.csv"
+else
+    cp "$TMP/resultados.csv" "$SALIDA"
+fi
@@ -0,0 +1,417 @@
+/**
+ * @file host_sim_grabador.c
+ * @brief Grabador de trazas de pines para el backend de simulación en PC.
+ * Se registra como monitor de host_sim (host_sim_setMonitor) y guarda en memoria dinámica cada cambio de PORTx, LATx y TRISx.
+ * Las mediciones se hacen sobre los flancos de PORTx (nivel real del pin), de modo que incluyen el efecto de TRIS en líneas de
+ * colector abierto como SCL y SDA.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "host_sim_grabador.h"
+
+static host_sim_cambio_t *cambios;
+static size_t num_cambios;
+static size_t capacidad;
+static uint32_t frecuencia;                             //Frecuencia del oscilador (Fosc), en Hz
+static uint64_t ciclo_inicial;
+static uint8_t inicial[HOST_SIM_NUM_PUERTOS][3];        //PORT, LAT y TRIS al iniciar la grabación
+
+/**
+ * @brief Función interna registrada como monitor de host_sim: agrega un cambio a la grabación
+ * @param cambio (const host_sim_cambio_t *): Cambio notificado por host_sim
+ * @param contexto (void *): Sin uso
+ * @return (void)
+*/
+static void host_sim_grabador_monitor(const host_sim_cambio_t *cambio, void *contexto) {
+    (void)contexto;
+    if(num_cambios == capacidad) {
+        size_t nueva = capacidad? 2*capacidad : 1024;
+        host_sim_cambio_t *p = (host_sim_cambio_t *)realloc(cambios,nueva*sizeof(host_sim_cambio_t));
+        if(!p) {
+            fprintf(stderr,"host_sim_grabador: memoria insuficiente, grabación detenida en el ciclo %llu\n",
+                (unsigned long long)cambio->ciclo);
+            host_sim_setMonitor(NULL,NULL);
+            return;
+        }
+        cambios = p;
+        capacidad = nueva;
+    }
+    cambios[num_cambios++] = *cambio;
+}
+
+/**
+ * @brief Función que inicia una grabación nueva, descartando la anterior. Debe llamarse después de host_sim_reset().
+ * Reemplaza al monitor que estuviera registrado con host_sim_setMonitor().
+ * @param xtal (uint32_t): Frecuencia del oscilador en Hz (normalmente _XTAL_FREQ), para convertir ciclos a tiempo
+ * @return (void)
+*/
+void host_sim_grabador_iniciar(uint32_t xtal) {
+    host_sim_setMonitor(NULL,NULL);
+    num_cambios = 0;
+    frecuencia = xtal;
+    for(uint8_t i=0;i!=HOST_SIM_NUM_PUERTOS;i++) {
+        inicial[i][HOST_SIM_PORT] = host_sim_getPines(i);
+        inicial[i][HOST_SIM_LAT] = host_sim_getLat(i);
+        inicial[i][HOST_SIM_TRIS] = host_sim_getTris(i);
+    }
+    ciclo_inicial = host_sim_getCiclos();
+    host_sim_setMonitor(host_sim_grabador_monitor,NULL);
+}
+
+/**
+ * @brief Función que detiene la grabación. Los cambios registrados se conservan para exportarlos o medirlos.
+ * @param (void)
+ * @return (void)
+*/
+void host_sim_grabador_detener(void) {
+    host_sim_setMonitor(NULL,NULL);
+}
+
+/**
+ * @brief Función que entrega los cambios registrados, en orden cronológico
+ * @param c (const host_sim_cambio_t **): Apuntador donde se escribe la dirección del primer cambio (puede ser NULL)
+ * @return (size_t) Número de cambios registrados
+*/
+size_t host_sim_grabador_getCambios(const host_sim_cambio_t **c) {
+    if(c)
+        *c = cambios;
+    return num_cambios;
+}
+
+/**
+ * @brief Función interna que convierte ciclos de instrucción (Fosc/4) a nanosegundos, redondeando
+ * @param ciclo (uint64_t): Ciclo de instrucción
+ * @return (uint64_t) Tiempo en nanosegundos
+*/
+static uint64_t host_sim_grabador_ns(uint64_t ciclo) {
+    return (ciclo/frecuencia)*4000000000ULL + ((ciclo%frecuencia)*4000000000ULL + frecuencia/2)/frecuencia;
+}
+
+/**
+ * @brief Función interna que genera el identificador VCD de una variable (caracteres imprimibles del '!' al '~')
+ * @param indice (unsigned): Índice de la variable
+ * @param id (char *): Cadena de salida, de al menos 4 caracteres
+ * @return (void)
+*/
+static void host_sim_grabador_id(unsigned indice, char *id) {
+    do {
+        *id++ = (char)('!' + indice%94);
+        indice /= 94;
+    } while(indice);
+    *id = '\0';
+}
+
+/**
+ * @brief Función que exporta la grabación en formato VCD, con escala de 1 ns. Por cada señal se generan tres variables: el nivel
+ * del pin (alcance "pines") y los bits de LAT y TRIS correspondientes (alcances "lat" y "tris").
+ * @param archivo (FILE *): Archivo de salida
+ * @param senales (const host_sim_senal_t *): Señales a exportar, NULL para exportar todos los pines (RA0 a RE7)
+ * @param num_senales (uint8_t): Número de señales (ignorado si senales es NULL)
+ * @return (int) 0 si se escribió correctamente, -1 en caso de error de escritura o de frecuencia no definida
+*/
+int host_sim_grabador_exportarVCD(FILE *archivo, const host_sim_senal_t *senales, uint8_t num_senales) {
+    static const char *alcances[3] = {"pines", "lat", "tris"};
+    static host_sim_senal_t todas[8*HOST_SIM_NUM_PUERTOS];
+    static char nombres[8*HOST_SIM_NUM_PUERTOS][4];
+    uint8_t estado[HOST_SIM_NUM_PUERTOS][3];
+    uint64_t t_anterior;
+    char id[4];
+    if(!frecuencia)
+        return -1;
+    if(!senales) {
+        for(uint8_t i=0;i!=8*HOST_SIM_NUM_PUERTOS;i++) {
+            sprintf(nombres[i],"R%c%u",'A'+i/8,i%8);
+            todas[i].nombre = nombres[i];
+            todas[i].puerto = i/8;
+            todas[i].pin = i%8;
+        }
+        senales = todas;
+        num_senales = 8*HOST_SIM_NUM_PUERTOS;
+    }
+    //Encabezado: la variable de la señal i en la vista v tiene el índice v*num_senales + i
+    fprintf(archivo,"$version host_sim_grabador $end\n$timescale 1 ns $end\n$scope module host_sim $end\n");
+    for(uint8_t v=0;v!=3;v++) {
+        fprintf(archivo,"$scope module %s $end\n",alcances[v]);
+        for(uint8_t i=0;i!=num_senales;i++) {
+            host_sim_grabador_id(v*num_senales + i,id);
+            fprintf(archivo,"$var wire 1 %s %s $end\n",id,senales[i].nombre);
+        }
+        fprintf(archivo,"$upscope $end\n");
+    }
+    fprintf(archivo,"$upscope $end\n$enddefinitions $end\n");
+    //Valores iniciales
+    memcpy(estado,inicial,sizeof(estado));
+    t_anterior = host_sim_grabador_ns(ciclo_inicial);
+    fprintf(archivo,"#%llu\n$dumpvars\n",(unsigned long long)t_anterior);
+    for(uint8_t v=0;v!=3;v++) {
+        for(uint8_t i=0;i!=num_senales;i++) {
+            host_sim_grabador_id(v*num_senales + i,id);
+            fprintf(archivo,"%u%s\n",(estado[senales[i].puerto][v]>>senales[i].pin) & 0x01,id);
+        }
+    }
+    fprintf(archivo,"$end\n");
+    //Cambios
+    for(size_t k=0;k!=num_cambios;k++) {
+        const host_sim_cambio_t *c = &cambios[k];
+        uint8_t modificados = estado[c->puerto][c->vista] ^ c->valor;
+        estado[c->puerto][c->vista] = c->valor;
+        for(uint8_t i=0;i!=num_senales;i++) {
+            if(senales[i].puerto != c->puerto || !((modificados>>senales[i].pin) & 0x01))
+                continue;
+            uint64_t t = host_sim_grabador_ns(c->ciclo);
+            if(t != t_anterior) {
+                fprintf(archivo,"#%llu\n",(unsigned long long)t);
+                t_anterior = t;
+            }
+            host_sim_grabador_id(c->vista*num_senales + i,id);
+            fprintf(archivo,"%u%s\n",(c->valor>>senales[i].pin) & 0x01,id);
+        }
+    }
+    return ferror(archivo)? -1 : 0;
+}
+
+/**
+ * @brief Función interna que escribe un entero sin signo en little endian
+ * @param archivo (FILE *): Archivo de salida
+ * @param valor (uint64_t): Valor a escribir
+ * @param bytes (uint8_t): Número de bytes
+ * @return (void)
+*/
+static void host_sim_grabador_escribirLE(FILE *archivo, uint64_t valor, uint8_t bytes) {
+    while(bytes--) {
+        fputc((int)(valor & 0xFF),archivo);
+        valor >>= 8;
+    }
+}
+
+/**
+ * @brief Función que exporta la grabación en el formato binario compacto descrito en host_sim_grabador.h
+ * @param archivo (FILE *): Archivo de salida, abierto en modo binario
+ * @return (int) 0 si se escribió correctamente, -1 en caso de error de escritura
+*/
+int host_sim_grabador_exportarBinario(FILE *archivo) {
+    uint64_t anterior = ciclo_inicial;
+    fwrite(HOST_SIM_GRABADOR_FIRMA,1,4,archivo);
+    host_sim_grabador_escribirLE(archivo,frecuencia,4);
+    host_sim_grabador_escribirLE(archivo,ciclo_inicial,8);
+    for(uint8_t i=0;i!=HOST_SIM_NUM_PUERTOS;i++) {
+        fputc(inicial[i][HOST_SIM_PORT],archivo);
+        fputc(inicial[i][HOST_SIM_LAT],archivo);
+        fputc(inicial[i][HOST_SIM_TRIS],archivo);
+    }
+    for(size_t k=0;k!=num_cambios;k++) {
+        uint64_t delta = cambios[k].ciclo - anterior;
+        anterior = cambios[k].ciclo;
+        do {    //LEB128
+            uint8_t byte = delta & 0x7F;
+            delta >>= 7;
+            fputc(delta? byte | 0x80 : byte,archivo);
+        } while(delta);
+        fputc((cambios[k].puerto<<2) | cambios[k].vista,archivo);
+        fputc(cambios[k].valor,archivo);
+    }
+    return ferror(archivo)? -1 : 0;
+}
+
+/**
+ * @brief Función interna que extrae los flancos de un pin a partir de los cambios de PORT grabados
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param pin (uint8_t): Número de bit (0-7)
+ * @param flancos (host_sim_flanco_t **): Apuntador donde se escribe el arreglo de flancos (liberar con free())
+ * @return (size_t) Número de flancos
+*/
+static size_t host_sim_grabador_flancos(uint8_t puerto, uint8_t pin, host_sim_flanco_t **flancos) {
+    uint8_t nivel = (inicial[puerto][HOST_SIM_PORT]>>pin) & 0x01;
+    size_t n = 0;
+    *flancos = (host_sim_flanco_t *)malloc((num_cambios? num_cambios : 1)*sizeof(host_sim_flanco_t));
+    if(!*flancos)
+        return 0;
+    for(size_t k=0;k!=num_cambios;k++) {
+        const host_sim_cambio_t *c = &cambios[k];
+        if(c->puerto != puerto || c->vista != HOST_SIM_PORT || ((c->valor>>pin) & 0x01) == nivel)
+            continue;
+        nivel ^= 0x01;
+        (*flancos)[n].ciclo = c->ciclo;
+        (*flancos)[n].puerto = puerto;
+        (*flancos)[n].pin = pin;
+        (*flancos)[n].nivel = nivel;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Función que mide frecuencia y ciclo de trabajo de un reloj (SCK, SCL) en cada transacción grabada. Una transacción es
+ * una ráfaga de flancos en la que ninguno dista más de 'reposo' ciclos del anterior; las que no tienen al menos un periodo
+ * completo se omiten.
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param pin (uint8_t): Número de bit (0-7)
+ * @param reposo (uint32_t): Separación mínima entre transacciones, en ciclos de instrucción
+ * @param transacciones (host_sim_reloj_t *): Arreglo de salida
+ * @param max (size_t): Capacidad del arreglo de salida
+ * @return (size_t) Número de transacciones medidas (a lo más max)
+*/
+size_t host_sim_grabador_medirReloj(uint8_t puerto, uint8_t pin, uint32_t reposo, host_sim_reloj_t *transacciones, size_t max) {
+    host_sim_flanco_t *f;
+    size_t n = host_sim_grabador_flancos(puerto,pin,&f);
+    size_t medidas = 0;
+    for(size_t i=0;i!=n && medidas!=max;) {
+        size_t fin = i;
+        uint64_t total = 0, alto = 0, subida = 0, alto_periodo = 0;
+        uint8_t con_subida = 0;
+        host_sim_reloj_t *r = &transacciones[medidas];
+        while(fin+1 != n && f[fin+1].ciclo - f[fin].ciclo <= reposo)
+            fin++;
+        memset(r,0,sizeof(*r));
+        r->inicio = f[i].ciclo;
+        r->fin = f[fin].ciclo;
+        for(size_t j=i;j<=fin;j++) {
+            if(!f[j].nivel) {                   //Fin del tiempo en alto del periodo en curso
+                if(con_subida)
+                    alto_periodo = f[j].ciclo - subida;
+                continue;
+            }
+            if(con_subida) {                    //Periodo completo de subida a subida
+                uint32_t periodo = (uint32_t)(f[j].ciclo - subida);
+                if(!r->periodos || periodo < r->periodo_min)
+                    r->periodo_min = periodo;
+                if(periodo > r->periodo_max)
+                    r->periodo_max = periodo;
+                r->periodos++;
+                total += periodo;
+                alto += alto_periodo;
+            }
+            subida = f[j].ciclo;
+            con_subida = 1;
+        }
+        if(r->periodos) {
+            r->periodo_medio = (double)total/r->periodos;
+            r->frecuencia = frecuencia/4.0/r->periodo_medio;
+            r->ciclo_trabajo = 100.0*alto/total;
+            medidas++;
+        }
+        i = fin+1;
+    }
+    free(f);
+    return medidas;
+}
+
+/**
+ * @brief Función que mide el periodo de bit de cada trama de UART (8N1) grabada en un pin
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param pin (uint8_t): Número de bit (0-7)
+ * @param ciclos_bit (uint32_t): Periodo de bit nominal en ciclos de instrucción (p. ej. CYCLES_BIT_PERIOD)
+ * @param tramas (host_sim_uart_t *): Arreglo de salida
+ * @param max (size_t): Capacidad del arreglo de salida
+ * @return (size_t) Número de tramas medidas (a lo más max)
+*/
+size_t host_sim_grabador_medirUART(uint8_t puerto, uint8_t pin, uint32_t ciclos_bit, host_sim_uart_t *tramas, size_t max) {
+    host_sim_flanco_t *f;
+    size_t n = host_sim_grabador_flancos(puerto,pin,&f);
+    size_t medidas = 0;
+    for(size_t i=0;i!=n && medidas!=max;) {
+        uint64_t inicio, fin, anterior;
+        uint32_t bits = 0;
+        uint8_t nivel = 0;
+        size_t j, k;
+        host_sim_uart_t *u = &tramas[medidas];
+        //Se busca el flanco de bajada del START; un pulso en bajo de menos de medio bit se descarta como glitch
+        if(f[i].nivel || (i+1 != n && f[i+1].ciclo - f[i].ciclo < ciclos_bit/2)) {
+            i++;
+            continue;
+        }
+        inicio = anterior = f[i].ciclo;
+        fin = inicio + 19UL*ciclos_bit/2;       //Mitad del bit de STOP
+        memset(u,0,sizeof(*u));
+        u->inicio = inicio;
+        for(j=i+1;j!=n && f[j].ciclo<=fin;j++) {
+            uint64_t intervalo = f[j].ciclo - anterior;
+            uint32_t abarcados = (uint32_t)((intervalo + ciclos_bit/2)/ciclos_bit);
+            double periodo;
+            if(!abarcados)
+                abarcados = 1;
+            periodo = (double)intervalo/abarcados;
+            if(!bits || periodo < u->periodo_min)
+                u->periodo_min = periodo;
+            if(periodo > u->periodo_max)
+                u->periodo_max = periodo;
+            bits += abarcados;
+            anterior = f[j].ciclo;
+        }
+        //Decodificación a la mitad de cada bit nominal
+        k = i;
+        for(uint8_t b=0;b!=9;b++) {
+            uint64_t t = inicio + (2UL*b + 3)*ciclos_bit/2;
+            while(k+1 < j && f[k+1].ciclo <= t)
+                k++;
+            nivel = f[k].nivel;
+            if(b != 8)
+                u->dato |= nivel<<b;
+        }
+        u->error_trama = !nivel;
+        if(bits) {
+            u->periodo_medio = (double)(anterior - inicio)/bits;
+            u->baud = frecuencia/4.0/u->periodo_medio;
+        }
+        medidas++;
+        i = j;
+    }
+    free(f);
+    return medidas;
+}
+
+/**
+ * @brief Función que imprime una línea por transacción con la medición de un reloj (ver host_sim_grabador_medirReloj)
+ * @param archivo (FILE *): Archivo de salida
+ * @param nombre (const char *): Nombre de la señal
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param pin (uint8_t): Número de bit (0-7)
+ * @param reposo (uint32_t): Separación mínima entre transacciones, en ciclos de instrucción
+ * @return (void)
+*/
+void host_sim_grabador_reporteReloj(FILE *archivo, const char *nombre, uint8_t puerto, uint8_t pin, uint32_t reposo) {
+    //Cada transacción tiene al menos dos flancos, por lo que num_cambios acota el número de transacciones
+    host_sim_reloj_t *r = (host_sim_reloj_t *)malloc((num_cambios? num_cambios : 1)*sizeof(host_sim_reloj_t));
+    size_t n;
+    if(!r)
+        return;
+    n = host_sim_grabador_medirReloj(puerto,pin,reposo,r,num_cambios);
+    fprintf(archivo,"# %s: transaccion inicio fin periodos periodo_min periodo_max periodo_medio frecuencia_hz ciclo_trabajo_%%\n",
+        nombre);
+    for(size_t k=0;k!=n;k++) {
+        fprintf(archivo,"%s %zu %llu %llu %u %u %u %.2f %.1f %.1f\n",nombre,k,(unsigned long long)r[k].inicio,
+            (unsigned long long)r[k].fin,r[k].periodos,r[k].periodo_min,r[k].periodo_max,r[k].periodo_medio,r[k].frecuencia,
+            r[k].ciclo_trabajo);
+    }
+    free(r);
+}
+
+/**
+ * @brief Función que imprime una línea por trama con la medición de UART (ver host_sim_grabador_medirUART)
+ * @param archivo (FILE *): Archivo de salida
+ * @param nombre (const char *): Nombre de la señal
+ * @param puerto (uint8_t): Índice del puerto simulado
+ * @param pin (uint8_t): Número de bit (0-7)
+ * @param ciclos_bit (uint32_t): Periodo de bit nominal en ciclos de instrucción
+ * @return (void)
+*/
+void host_sim_grabador_reporteUART(FILE *archivo, const char *nombre, uint8_t puerto, uint8_t pin, uint32_t ciclos_bit) {
+    host_sim_uart_t *u = (host_sim_uart_t *)malloc((num_cambios? num_cambios : 1)*sizeof(host_sim_uart_t));
+    size_t n;
+    if(!u)
+        return;
+    n = host_sim_grabador_medirUART(puerto,pin,ciclos_bit,u,num_cambios);
+    fprintf(archivo,"# %s: trama inicio dato error_trama periodo_min periodo_max periodo_medio baud error_%% (nominal %u ciclos)\n",
+        nombre,ciclos_bit);
+    for(size_t k=0;k!=n;k++) {
+        fprintf(archivo,"%s %zu %llu 0x%02X %u %.2f %.2f %.2f %.0f %+.2f\n",nombre,k,(unsigned long long)u[k].inicio,u[k].dato,
+            u[k].error_trama,u[k].periodo_min,u[k].periodo_max,u[k].periodo_medio,u[k].baud,
+            u[k].periodo_medio? 100.0*(u[k].periodo_medio - ciclos_bit)/ciclos_bit : 0.0);
+    }
+    free(u);
+}
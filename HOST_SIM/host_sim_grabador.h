@@ -0,0 +1,86 @@
+/**
+ * @file host_sim_grabador.h
+ * @brief Grabador de trazas de pines para el backend de simulación en PC.
+ * Registra con marca de ciclo cada cambio de PORTx, LATx y TRISx del puerto simulado, exporta la grabación en formato VCD
+ * (GTKWave, sigrok/PulseView) o en un formato binario compacto, y mide frecuencia y ciclo de trabajo de relojes (SCK, SCL) y
+ * periodos de bit de UART por transacción.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#ifndef HOST_SIM_GRABADOR_H
+#define	HOST_SIM_GRABADOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "host_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Señal con nombre para la exportación a VCD
+*/
+typedef struct {
+    const char *nombre;
+    uint8_t puerto;     //HOST_SIM_PUERTO_x
+    uint8_t pin;        //Número de bit (0-7)
+} host_sim_senal_t;
+
+/**
+ * Medición de un reloj durante una transacción (ráfaga de flancos separada de la siguiente por más de 'reposo' ciclos).
+ * Los periodos se miden de flanco de subida a flanco de subida.
+*/
+typedef struct {
+    uint64_t inicio;            //Ciclo del primer flanco de la transacción
+    uint64_t fin;               //Ciclo del último flanco de la transacción
+    uint32_t periodos;          //Periodos completos medidos
+    uint32_t periodo_min;       //Periodo mínimo, en ciclos de instrucción
+    uint32_t periodo_max;       //Periodo máximo, en ciclos de instrucción
+    double periodo_medio;       //Periodo promedio, en ciclos de instrucción
+    double frecuencia;          //Frecuencia promedio, en Hz
+    double ciclo_trabajo;       //Porcentaje del periodo en alto
+} host_sim_reloj_t;
+
+/**
+ * Medición de una trama de UART (8N1, reposo en alto). El periodo de bit se estima dividiendo el tiempo entre flancos consecutivos
+ * entre el número de bits que abarca (redondeado con el periodo nominal).
+*/
+typedef struct {
+    uint64_t inicio;            //Ciclo del flanco de START
+    uint8_t dato;               //Dato decodificado a la mitad de cada bit nominal
+    uint8_t error_trama;        //1 si el bit de STOP está en bajo
+    double periodo_min;         //Periodo de bit mínimo estimado, en ciclos de instrucción
+    double periodo_max;         //Periodo de bit máximo estimado, en ciclos de instrucción
+    double periodo_medio;       //Periodo de bit promedio del START al último flanco, en ciclos de instrucción
+    double baud;                //Velocidad equivalente al periodo promedio
+} host_sim_uart_t;
+
+/**
+ * Formato binario (little endian):
+ * - Encabezado: "HSG1", uint32_t frecuencia del oscilador, uint64_t ciclo inicial, y PORT, LAT y TRIS iniciales de cada uno de
+ *   los HOST_SIM_NUM_PUERTOS puertos (3 bytes por puerto).
+ * - Un registro por cambio: ciclos transcurridos desde el registro anterior (entero sin signo LEB128), un byte con
+ *   (puerto << 2) | vista, y el valor del registro. Normalmente 3 bytes por cambio.
+*/
+#define HOST_SIM_GRABADOR_FIRMA "HSG1"
+
+/**
+ * Prototipos de funciones
+*/
+void host_sim_grabador_iniciar(uint32_t xtal);
+void host_sim_grabador_detener(void);
+size_t host_sim_grabador_getCambios(const host_sim_cambio_t **cambios);
+int host_sim_grabador_exportarVCD(FILE *archivo, const host_sim_senal_t *senales, uint8_t num_senales);
+int host_sim_grabador_exportarBinario(FILE *archivo);
+size_t host_sim_grabador_medirReloj(uint8_t puerto, uint8_t pin, uint32_t reposo, host_sim_reloj_t *transacciones, size_t max);
+size_t host_sim_grabador_medirUART(uint8_t puerto, uint8_t pin, uint32_t ciclos_bit, host_sim_uart_t *tramas, size_t max);
+void host_sim_grabador_reporteReloj(FILE *archivo, const char *nombre, uint8_t puerto, uint8_t pin, uint32_t reposo);
+void host_sim_grabador_reporteUART(FILE *archivo, const char *nombre, uint8_t puerto, uint8_t pin, uint32_t ciclos_bit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* HOST_SIM_GRABADOR_H */
@@ -0,0 +1,7 @@
+/**
+ * @file p18cxxx.h
+ * @brief Sustituto de <p18cxxx.h> (incluido por pconfig.h) para compilación en PC mediante host_sim
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#include "xc.h"
@@ -0,0 +1,73 @@
+/**
+ * @file serial_sw_tabla.c
+ * @brief Programa para PC que genera la tabla de error de velocidad de serial_sw para cristales y velocidades estándar.
+ * Evalúa en tiempo de ejecución las mismas macros de serial_sw.h que verifica serial_sw.c en tiempo de compilación, sustituyendo
+ * _XTAL_FREQ y SW_BAUDRATE por variables. Indica por cada cristal la velocidad más alta que compila en cada modo.
+ * Compilación: gcc -I HOST_SIM HOST_SIM/serial_sw_tabla.c -o serial_sw_tabla
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include "xc.h"
+
+static unsigned long xtal;
+static unsigned long baud;
+
+#define _XTAL_FREQ  xtal
+#define SW_BAUDRATE baud
+#include "../SERIAL_SW/serial_sw.h"
+
+static const unsigned long cristales[] = {
+    4000000UL, 8000000UL, 10000000UL, 11059200UL, 12000000UL, 16000000UL, 18432000UL, 20000000UL,
+    32000000UL, 40000000UL, 48000000UL, 64000000UL
+};
+
+static const unsigned long velocidades[] = {
+    1200UL, 2400UL, 4800UL, 9600UL, 14400UL, 19200UL, 38400UL, 57600UL, 115200UL
+};
+
+#define NUM_ELEMENTOS(a) (sizeof(a)/sizeof((a)[0]))
+
+/**
+ * @brief Función que determina si la combinación actual de xtal y baud compila en un modo
+ * @param periodo_minimo (unsigned long): SERIAL_SW_PERIODO_MINIMO del modo
+ * @param error (unsigned long): Error de temporización de la trama del modo, en centésimas de porcentaje
+ * @return (int) 1 si la combinación es válida, 0 en caso contrario
+*/
+static int valida(unsigned long periodo_minimo, unsigned long error) {
+    return CYCLES_BIT_PERIOD >= periodo_minimo && error <= SERIAL_SW_TOLERANCIA;
+}
+
+int main(void) {
+    unsigned long error_entero, error_frac;
+    unsigned long max_entero, max_frac, max_mayoria;
+
+    printf("Tolerancia: %lu.%02lu %%\n\n",(unsigned long)SERIAL_SW_TOLERANCIA/100,(unsigned long)SERIAL_SW_TOLERANCIA%100);
+    printf("%10s %8s %8s %10s %10s %10s %7s %7s %7s\n","_XTAL_FREQ","baud","periodo","baud real","error ent","error frac",
+        "entero","frac","mayoria");
+    for(size_t i=0;i!=NUM_ELEMENTOS(cristales);i++) {
+        xtal = cristales[i];
+        max_entero = max_frac = max_mayoria = 0;
+        for(size_t j=0;j!=NUM_ELEMENTOS(velocidades);j++) {
+            baud = velocidades[j];
+            if(CYCLES_BIT_PERIOD == 0)
+                continue;
+            error_entero = SERIAL_SW_ERROR_ENTERO_MCICLOS/CYCLES_BIT_PERIOD;
+            error_frac = SERIAL_SW_ERROR_FRAC_MCICLOS/CYCLES_BIT_PERIOD;
+            printf("%10lu %8lu %8lu %10lu %7lu.%02lu%% %7lu.%02lu%% %7s %7s %7s\n",xtal,baud,(unsigned long)CYCLES_BIT_PERIOD,
+                (unsigned long)SERIAL_SW_BAUD_REAL,error_entero/100,error_entero%100,error_frac/100,error_frac%100,
+                valida(SERIAL_SW_PERIODO_MINIMO_ENTERO,error_entero)? "si" : "no",
+                valida(SERIAL_SW_PERIODO_MINIMO_FRAC,error_frac)? "si" : "no",
+                valida(SERIAL_SW_PERIODO_MINIMO_MAYORIA,error_entero)? "si" : "no");
+            if(valida(SERIAL_SW_PERIODO_MINIMO_ENTERO,error_entero))
+                max_entero = baud;
+            if(valida(SERIAL_SW_PERIODO_MINIMO_FRAC,error_frac))
+                max_frac = baud;
+            if(valida(SERIAL_SW_PERIODO_MINIMO_MAYORIA,error_entero))
+                max_mayoria = baud;
+        }
+        printf("%10lu máxima: entero %lu, fraccional %lu, mayoría %lu\n\n",xtal,max_entero,max_frac,max_mayoria);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file xc.h
+ * @brief Sustituto de <xc.h> para compilar los protocolos emulados por software en PC mediante host_sim.
+ * Define los registros PORTx/LATx/TRISx (A a E) con sus variantes xbits, los retardos _delay(), __delay_us() y __delay_ms(),
+ * y los tipos de 24 bits de XC8. Los retardos en microsegundos requieren _XTAL_FREQ, igual que en XC8.
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+#ifndef HOST_SIM_XC_H
+#define	HOST_SIM_XC_H
+
+#include <stdint.h>
+#include "host_sim.h"
+
+/**
+ * Tipos de 24 bits de XC8. En PC ocupan 4 bytes, por lo que sizeof(uint24_t) difiere del microcontrolador.
+*/
+typedef uint32_t uint24_t;
+typedef int32_t int24_t;
+
+/**
+ * Retardos. Cada ciclo de instrucción equivale a 4 ciclos de oscilador (_XTAL_FREQ).
+*/
+#define _delay(x)       host_sim_delay((uint32_t)(x))
+#define __delay_us(x)   _delay((unsigned long)((x)*(_XTAL_FREQ/4000000.0)))
+#define __delay_ms(x)   _delay((unsigned long)((x)*(_XTAL_FREQ/4000.0)))
+#define NOP()           host_sim_delay(1)
+#define Nop()           NOP()
+
+/**
+ * Definición de tipos de bits de los registros
+*/
+#define HOST_SIM_BITS(tipo,prefijo) typedef struct { \
+    uint8_t prefijo##0:1; uint8_t prefijo##1:1; uint8_t prefijo##2:1; uint8_t prefijo##3:1; \
+    uint8_t prefijo##4:1; uint8_t prefijo##5:1; uint8_t prefijo##6:1; uint8_t prefijo##7:1; \
+} tipo;
+
+HOST_SIM_BITS(PORTAbits_t,RA)
+HOST_SIM_BITS(LATAbits_t,LATA)
+HOST_SIM_BITS(TRISAbits_t,TRISA)
+HOST_SIM_BITS(PORTBbits_t,RB)
+HOST_SIM_BITS(LATBbits_t,LATB)
+HOST_SIM_BITS(TRISBbits_t,TRISB)
+HOST_SIM_BITS(PORTCbits_t,RC)
+HOST_SIM_BITS(LATCbits_t,LATC)
+HOST_SIM_BITS(TRISCbits_t,TRISC)
+HOST_SIM_BITS(PORTDbits_t,RD)
+HOST_SIM_BITS(LATDbits_t,LATD)
+HOST_SIM_BITS(TRISDbits_t,TRISD)
+HOST_SIM_BITS(PORTEbits_t,RE)
+HOST_SIM_BITS(LATEbits_t,LATE)
+HOST_SIM_BITS(TRISEbits_t,TRISE)
+
+/**
+ * Registros de puertos. Cada acceso pasa por host_sim_registro().
+*/
+#define PORTA     (*host_sim_registro(HOST_SIM_PUERTO_A,HOST_SIM_PORT))
+#define PORTAbits (*(volatile PORTAbits_t *)host_sim_registro(HOST_SIM_PUERTO_A,HOST_SIM_PORT))
+#define LATA      (*host_sim_registro(HOST_SIM_PUERTO_A,HOST_SIM_LAT))
+#define LATAbits  (*(volatile LATAbits_t *)host_sim_registro(HOST_SIM_PUERTO_A,HOST_SIM_LAT))
+#define TRISA     (*host_sim_registro(HOST_SIM_PUERTO_A,HOST_SIM_TRIS))
+#define TRISAbits (*(volatile TRISAbits_t *)host_sim_registro(HOST_SIM_PUERTO_A,HOST_SIM_TRIS))
+
+#define PORTB     (*host_sim_registro(HOST_SIM_PUERTO_B,HOST_SIM_PORT))
+#define PORTBbits (*(volatile PORTBbits_t *)host_sim_registro(HOST_SIM_PUERTO_B,HOST_SIM_PORT))
+#define LATB      (*host_sim_registro(HOST_SIM_PUERTO_B,HOST_SIM_LAT))
+#define LATBbits  (*(volatile LATBbits_t *)host_sim_registro(HOST_SIM_PUERTO_B,HOST_SIM_LAT))
+#define TRISB     (*host_sim_registro(HOST_SIM_PUERTO_B,HOST_SIM_TRIS))
+#define TRISBbits (*(volatile TRISBbits_t *)host_sim_registro(HOST_SIM_PUERTO_B,HOST_SIM_TRIS))
+
+#define PORTC     (*host_sim_registro(HOST_SIM_PUERTO_C,HOST_SIM_PORT))
+#define PORTCbits (*(volatile PORTCbits_t *)host_sim_registro(HOST_SIM_PUERTO_C,HOST_SIM_PORT))
+#define LATC      (*host_sim_registro(HOST_SIM_PUERTO_C,HOST_SIM_LAT))
+#define LATCbits  (*(volatile LATCbits_t *)host_sim_registro(HOST_SIM_PUERTO_C,HOST_SIM_LAT))
+#define TRISC     (*host_sim_registro(HOST_SIM_PUERTO_C,HOST_SIM_TRIS))
+#define TRISCbits (*(volatile TRISCbits_t *)host_sim_registro(HOST_SIM_PUERTO_C,HOST_SIM_TRIS))
+
+#define PORTD     (*host_sim_registro(HOST_SIM_PUERTO_D,HOST_SIM_PORT))
+#define PORTDbits (*(volatile PORTDbits_t *)host_sim_registro(HOST_SIM_PUERTO_D,HOST_SIM_PORT))
+#define LATD      (*host_sim_registro(HOST_SIM_PUERTO_D,HOST_SIM_LAT))
+#define LATDbits  (*(volatile LATDbits_t *)host_sim_registro(HOST_SIM_PUERTO_D,HOST_SIM_LAT))
+#define TRISD     (*host_sim_registro(HOST_SIM_PUERTO_D,HOST_SIM_TRIS))
+#define TRISDbits (*(volatile TRISDbits_t *)host_sim_registro(HOST_SIM_PUERTO_D,HOST_SIM_TRIS))
+
+#define PORTE     (*host_sim_registro(HOST_SIM_PUERTO_E,HOST_SIM_PORT))
+#define PORTEbits (*(volatile PORTEbits_t *)host_sim_registro(HOST_SIM_PUERTO_E,HOST_SIM_PORT))
+#define LATE      (*host_sim_registro(HOST_SIM_PUERTO_E,HOST_SIM_LAT))
+#define LATEbits  (*(volatile LATEbits_t *)host_sim_registro(HOST_SIM_PUERTO_E,HOST_SIM_LAT))
+#define TRISE     (*host_sim_registro(HOST_SIM_PUERTO_E,HOST_SIM_TRIS))
+#define TRISEbits (*(volatile TRISEbits_t *)host_sim_registro(HOST_SIM_PUERTO_E,HOST_SIM_TRIS))
+
+/**
+ * Registros de interrupciones y temporizador 1 sin comportamiento simulado: sólo permiten compilar las configuraciones por defecto
+ * de los controladores. Para probar rutinas de interrupción se sustituyen sus macros de control por host_sim_setTimer().
+*/
+typedef struct {
+    uint8_t RBIF:1; uint8_t INT0IF:1; uint8_t TMR0IF:1; uint8_t RBIE:1;
+    uint8_t INT0IE:1; uint8_t TMR0IE:1; uint8_t PEIE:1; uint8_t GIE:1;
+} INTCONbits_t;
+typedef struct {
+    uint8_t RBIP:1; uint8_t :1; uint8_t TMR0IP:1; uint8_t :1;
+    uint8_t INTEDG2:1; uint8_t INTEDG1:1; uint8_t INTEDG0:1; uint8_t RBPU:1;
+} INTCON2bits_t;
+typedef struct {
+    uint8_t INT1IF:1; uint8_t INT2IF:1; uint8_t :1; uint8_t INT1IE:1;
+    uint8_t INT2IE:1; uint8_t :1; uint8_t INT1IP:1; uint8_t INT2IP:1;
+} INTCON3bits_t;
+typedef struct {
+    uint8_t TMR1IF:1; uint8_t TMR2IF:1; uint8_t CCP1IF:1; uint8_t SSPIF:1;
+    uint8_t TXIF:1; uint8_t RCIF:1; uint8_t ADIF:1; uint8_t PSPIF:1;
+} PIR1bits_t;
+typedef struct {
+    uint8_t TMR1IE:1; uint8_t TMR2IE:1; uint8_t CCP1IE:1; uint8_t SSPIE:1;
+    uint8_t TXIE:1; uint8_t RCIE:1; uint8_t ADIE:1; uint8_t PSPIE:1;
+} PIE1bits_t;
+typedef struct {
+    uint8_t TMR1ON:1; uint8_t TMR1CS:1; uint8_t T1SYNC:1; uint8_t T1OSCEN:1;
+    uint8_t T1CKPS:2; uint8_t T1RUN:1; uint8_t RD16:1;
+} T1CONbits_t;
+
+extern volatile uint8_t host_sim_INTCON, host_sim_INTCON2, host_sim_INTCON3, host_sim_PIR1, host_sim_PIE1, host_sim_T1CON;
+extern volatile uint16_t host_sim_TMR1;
+
+#define INTCON      host_sim_INTCON
+#define INTCONbits  (*(volatile INTCONbits_t *)&host_sim_INTCON)
+#define INTCON2     host_sim_INTCON2
+#define INTCON2bits (*(volatile INTCON2bits_t *)&host_sim_INTCON2)
+#define INTCON3     host_sim_INTCON3
+#define INTCON3bits (*(volatile INTCON3bits_t *)&host_sim_INTCON3)
+#define PIR1        host_sim_PIR1
+#define PIR1bits    (*(volatile PIR1bits_t *)&host_sim_PIR1)
+#define PIE1        host_sim_PIE1
+#define PIE1bits    (*(volatile PIE1bits_t *)&host_sim_PIE1)
+#define T1CON       host_sim_T1CON
+#define T1CONbits   (*(volatile T1CONbits_t *)&host_sim_T1CON)
+#define TMR1        host_sim_TMR1
+
+#endif	/* HOST_SIM_XC_H */
@@ -11,19 +11,109 @@
 #include "../pconfig.h"
 #include "../../utils/utils.h"
 
+/*
+	Retardos por fase según el perfil de temporización I2C_SW_SPEED
+*/
+#if I2C_SW_RETARDO_NS(I2C_SW_T_LOW_NS) > 0
+#define I2C_SW_ESPERA_LOW() _delay(I2C_SW_RETARDO_NS(I2C_SW_T_LOW_NS));
+#else
+#define I2C_SW_ESPERA_LOW()
+#endif
+#if I2C_SW_RETARDO_NS(I2C_SW_T_HIGH_NS) > 0
+#define I2C_SW_ESPERA_HIGH() _delay(I2C_SW_RETARDO_NS(I2C_SW_T_HIGH_NS));
+#else
+#define I2C_SW_ESPERA_HIGH()
+#endif
+#if I2C_SW_RETARDO_NS(I2C_SW_T_SU_STA_NS) > 0
+#define I2C_SW_ESPERA_SU_STA() _delay(I2C_SW_RETARDO_NS(I2C_SW_T_SU_STA_NS));
+#else
+#define I2C_SW_ESPERA_SU_STA()
+#endif
+#if I2C_SW_RETARDO_NS(I2C_SW_T_HD_STA_NS) > 0
+#define I2C_SW_ESPERA_HD_STA() _delay(I2C_SW_RETARDO_NS(I2C_SW_T_HD_STA_NS));
+#else
+#define I2C_SW_ESPERA_HD_STA()
+#endif
+#if I2C_SW_RETARDO_NS(I2C_SW_T_SU_STO_NS) > 0
+#define I2C_SW_ESPERA_SU_STO() _delay(I2C_SW_RETARDO_NS(I2C_SW_T_SU_STO_NS));
+#else
+#define I2C_SW_ESPERA_SU_STO()
+#endif
+#if I2C_SW_RETARDO_NS(I2C_SW_T_BUF_NS) > 0
+#define I2C_SW_ESPERA_BUF() _delay(I2C_SW_RETARDO_NS(I2C_SW_T_BUF_NS));
+#else
+#define I2C_SW_ESPERA_BUF()
+#endif
+
 #ifndef SLAVE_MODE_SW
+static i2c_sw_estado_t i2c_sw_estado;
+
+#if I2C_SW_STRETCH_US
+/**
+ * @brief Función interna de espera de SCL en alto con límite de I2C_SW_ESPERA_STRETCH iteraciones (clock stretching del esclavo).
+ * Si la línea no sube se registra I2C_SW_TIMEOUT; con el bus en error ya no se espera.
+ * @param (void)
+ * @return (void)
+*/
+static void i2c_sw_esperarSCL(void) {
+    uint32_t espera = I2C_SW_ESPERA_STRETCH;
+    if(i2c_sw_estado >= I2C_SW_TIMEOUT)
+        return;
+    while(!I2C_SW_SCL_PIN) {
+        if(!espera--) {
+            i2c_sw_estado = I2C_SW_TIMEOUT;
+            return;
+        }
+    }
+}
+#endif
+
+#ifdef I2C_SW_MULTI_MAESTRO
+/**
+ * @brief Función interna que espera a que el bus esté libre: SDA y SCL en alto durante I2C_SW_ESPERA_LIBRE iteraciones seguidas,
+ * con límite total de I2C_SW_ESPERA_STRETCH iteraciones (sin límite si I2C_SW_STRETCH_US es 0)
+ * @param (void)
+ * @return (bool) true si el bus quedó libre, false si se agotó el tiempo límite
+*/
+static bool i2c_sw_esperarBusLibre(void) {
+    uint32_t libre = I2C_SW_ESPERA_LIBRE;
+    uint32_t espera = I2C_SW_ESPERA_STRETCH;
+    while(libre) {
+        if(I2C_SW_SCL_PIN && I2C_SW_SDA_PIN)
+            libre--;
+        else
+            libre = I2C_SW_ESPERA_LIBRE;
+        if(I2C_SW_ESPERA_STRETCH && !espera--)
+            return false;
+    }
+    return true;
+}
+#endif
+
 /**
- * @brief Función para generar condición START (S) en el bus i2c por software
+ * @brief Función para generar condición START (S) en el bus i2c por software. Si un esclavo retiene SDA en bajo (transacción
+ * interrumpida por un reinicio del maestro) se ejecuta primero la secuencia de recuperación del bus. En modo multimaestro se
+ * espera en su lugar a que el bus esté libre.
  * @param (void)
  * @return (void)
 */
 void i2c_sw_start() {
+    i2c_sw_estado = I2C_SW_OK;
+#ifdef I2C_SW_MULTI_MAESTRO
+    if(!i2c_sw_esperarBusLibre()) {
+        i2c_sw_estado = I2C_SW_BUS_OCUPADO;
+        return;
+    }
+#endif
     SW_SDA_1
-    __delay_us(4);
     SW_SCL_1
-    __delay_us(4);
+#ifndef I2C_SW_MULTI_MAESTRO
+    if(!I2C_SW_SDA_PIN && i2c_sw_recuperarBus() != I2C_SW_OK)
+        return;
+#endif
+    I2C_SW_ESPERA_SU_STA()
     SW_SDA_0
-    __delay_us(4);
+    I2C_SW_ESPERA_HD_STA()
     SW_SCL_0
     //Secuencia de START
 }
@@ -34,12 +124,16 @@ void i2c_sw_start() {
  * @return (void)
 */
 void i2c_sw_stop() {
+#ifdef I2C_SW_MULTI_MAESTRO
+    if(i2c_sw_estado == I2C_SW_ARBITRAJE_PERDIDO || i2c_sw_estado == I2C_SW_BUS_OCUPADO)
+        return;     //El bus pertenece a otro maestro
+#endif
     SW_SDA_0
-    __delay_us(4);
+    I2C_SW_ESPERA_LOW()
     SW_SCL_1
-    __delay_us(4);
+    I2C_SW_ESPERA_SU_STO()
     SW_SDA_1
-    __delay_us(4);
+    I2C_SW_ESPERA_BUF()
     //Secuencia de STOP
 }
 
@@ -49,37 +143,56 @@ void i2c_sw_stop() {
  * @return (void)
 */
 void i2c_sw_restart() {
+#ifdef I2C_SW_MULTI_MAESTRO
+    if(i2c_sw_estado == I2C_SW_ARBITRAJE_PERDIDO || i2c_sw_estado == I2C_SW_BUS_OCUPADO)
+        return;
+#endif
     SW_SDA_1
-    __delay_us(4);
+    I2C_SW_ESPERA_LOW()
     SW_SCL_1
-    __delay_us(4);
+    I2C_SW_ESPERA_SU_STA()
     SW_SDA_0
-    __delay_us(4);
+    I2C_SW_ESPERA_HD_STA()
     //Secuencia RESTART
 }
 
 /**
  * @brief Función para escribir un byte en el bus i2c por software
  * @param dato (uint8_t): Dato de 8 bits a trasmitir mediante el bus i2c por software
- * @return (bool)  bit !ACK (acknowledge), 0 indica ACK, mientras 1 indica NACK
+ * @return (bool) true si el esclavo respondió con ACK, false si respondió con NACK o si el bus está en error (ver i2c_sw_getEstado())
 */
 bool i2c_sw_writeByte(uint8_t dato) {
     uint8_t i,ack_bit;
+    if(i2c_sw_estado >= I2C_SW_TIMEOUT)
+        return false;
     for(i=0;i!=8;i++) {
-        SW_SCL_0;       //Reloj en bajo
-        __delay_us(4);
+        SW_SCL_0        //Reloj en bajo
         if(dato&0x80) //Si el último bit de dato es 1
             SW_SDA_1   //Pon en alto la línea de datos
         else
             SW_SDA_0   //Si no, ponla en bajo
+        I2C_SW_ESPERA_LOW()
         SW_SCL_1      //Reloj en alto
-        __delay_us(4);
+#ifdef I2C_SW_MULTI_MAESTRO
+        if((dato&0x80) && !I2C_SW_SDA_PIN) {    //Otro maestro mantiene SDA en bajo: arbitraje perdido, SDA y SCL quedan liberadas
+            i2c_sw_estado = I2C_SW_ARBITRAJE_PERDIDO;
+            return false;
+        }
+#endif
+        I2C_SW_ESPERA_HIGH()
         dato<<=1;     //Corre dato un lugar a la izquierda
     }
     SW_SCL_0
-    ack_bit=I2C_SW_SDA_PIN; //Lee estado del bit ack de la línea de datos
+    SW_SDA_1    //Libera la línea de datos para que el esclavo responda
+    I2C_SW_ESPERA_LOW()
     SW_SCL_1
+    ack_bit=I2C_SW_SDA_PIN; //Lee estado del bit ack de la línea de datos
+    I2C_SW_ESPERA_HIGH()
     SW_SCL_0  //Pulso de reloj
+    if(i2c_sw_estado >= I2C_SW_TIMEOUT)
+        return false;
+    if(ack_bit)
+        i2c_sw_estado = I2C_SW_NACK;
     return !ack_bit;    //Devuelve valor de bit ack
 }
 
@@ -90,32 +203,333 @@ bool i2c_sw_writeByte(uint8_t dato) {
 */
 uint8_t i2c_sw_readByte(bool ack) {
     uint8_t i,dato=0;
+#ifdef I2C_SW_MULTI_MAESTRO
+    if(i2c_sw_estado == I2C_SW_ARBITRAJE_PERDIDO || i2c_sw_estado == I2C_SW_BUS_OCUPADO)
+        return 0xFF;
+#endif
+    SW_SDA_1    //Libera la línea de datos para el esclavo
     for(i=0;i!=8;i++) {
         SW_SCL_0
-        __delay_us(4);
+        I2C_SW_ESPERA_LOW()
         SW_SCL_1       //Pulso de reloj para que entre dato
-        __delay_us(4);
+        dato<<=1;
         if(I2C_SW_SDA_PIN)
             dato|=0x01;
-        if(i<7)
-            dato<<=1;   
+        I2C_SW_ESPERA_HIGH()
     }
     SW_SCL_0
-    __delay_us(4);
     if(ack==0) //NACK
         SW_SDA_1
     else //ACK
         SW_SDA_0
-    __delay_us(4);
+    I2C_SW_ESPERA_LOW()
     SW_SCL_1
-    __delay_us(4);
-    SW_SCL_0;
-    __delay_us(4);
-    SW_SDA_1;   //Cambia a entrada para que el esclavo pueda mandar más datos, si es necesario
-    __delay_us(4);
+#ifdef I2C_SW_MULTI_MAESTRO
+    if(!ack && !I2C_SW_SDA_PIN) {   //Otro maestro envía ACK mientras éste envía NACK
+        i2c_sw_estado = I2C_SW_ARBITRAJE_PERDIDO;
+        return dato;
+    }
+#endif
+    I2C_SW_ESPERA_HIGH()
+    SW_SCL_0
+    SW_SDA_1   //Cambia a entrada para que el esclavo pueda mandar más datos, si es necesario
     return dato;
 }
 
+#ifdef I2C_SW_ASYNC
+#define I2C_SW_ASYNC_MASCARA    (I2C_SW_ASYNC_COLA_SIZE-1)
+
+/*
+	Fases del motor de transacciones; cada interrupción ejecuta una
+*/
+#define I2C_SW_ASYNC_INACTIVO       0   //Cola vacía, temporizador detenido
+#define I2C_SW_ASYNC_START          1   //SDA a bajo con SCL en alto (START o RESTART)
+#define I2C_SW_ASYNC_START_SCL      2   //SCL a bajo y primer bit de la dirección
+#define I2C_SW_ASYNC_BIT_BAJO       3
+#define I2C_SW_ASYNC_BIT_ALTO       4
+#define I2C_SW_ASYNC_ACK_BAJO       5
+#define I2C_SW_ASYNC_ACK_ALTO       6
+#define I2C_SW_ASYNC_RESTART_BAJO   7
+#define I2C_SW_ASYNC_RESTART_ALTO   8
+#define I2C_SW_ASYNC_STOP_BAJO      9
+#define I2C_SW_ASYNC_STOP_ALTO      10
+#define I2C_SW_ASYNC_STOP_SDA       11
+#define I2C_SW_ASYNC_LIBRE          12  //Tiempo de bus libre después de STOP
+
+/*
+	Tipo del byte en curso
+*/
+#define I2C_SW_ASYNC_DIR_W          0
+#define I2C_SW_ASYNC_DATO_W         1
+#define I2C_SW_ASYNC_DIR_R          2
+#define I2C_SW_ASYNC_DATO_R         3
+
+static i2c_sw_transaccion_t *i2c_sw_async_buffer[I2C_SW_ASYNC_COLA_SIZE];
+static volatile uint8_t i2c_sw_async_cabeza;    //Siguiente lugar libre
+static volatile uint8_t i2c_sw_async_cola;      //Siguiente transacción a ejecutar
+static volatile uint8_t i2c_sw_async_fase = I2C_SW_ASYNC_INACTIVO;
+static i2c_sw_transaccion_t *i2c_sw_async_actual;
+static i2c_sw_estado_t i2c_sw_async_estado;
+static uint8_t i2c_sw_async_tipo;
+static uint8_t i2c_sw_async_dato;
+static uint8_t i2c_sw_async_bit;
+static uint16_t i2c_sw_async_indice;
+static uint32_t i2c_sw_async_espera;            //Interrupciones con SCL retenida o con el bus ocupado
+#ifdef I2C_SW_MULTI_MAESTRO
+static uint32_t i2c_sw_async_libre;             //Interrupciones seguidas con el bus libre
+#endif
+static bool i2c_sw_async_reinicio;              //El siguiente START es el de la lectura
+
+/**
+ * @brief Función interna que toma la siguiente transacción de la cola, o detiene el temporizador si está vacía
+ * @param (void)
+ * @return (void)
+*/
+static void i2c_sw_async_siguiente(void) {
+    if(i2c_sw_async_cola == i2c_sw_async_cabeza) {
+        i2c_sw_async_fase = I2C_SW_ASYNC_INACTIVO;
+        I2C_SW_ASYNC_TIMER_DETENER();
+        return;
+    }
+    i2c_sw_async_actual = i2c_sw_async_buffer[i2c_sw_async_cola];
+    i2c_sw_async_cola = (i2c_sw_async_cola + 1) & I2C_SW_ASYNC_MASCARA;
+    i2c_sw_async_estado = I2C_SW_OK;
+    i2c_sw_async_reinicio = false;
+    i2c_sw_async_espera = 0;
+#ifdef I2C_SW_MULTI_MAESTRO
+    i2c_sw_async_libre = 0;
+#endif
+    i2c_sw_async_fase = I2C_SW_ASYNC_START;
+}
+
+/**
+ * @brief Función interna que termina la transacción en curso: libera SDA y SCL, publica el estado, ejecuta la función de aviso y
+ * pasa a la siguiente transacción
+ * @param (void)
+ * @return (void)
+*/
+static void i2c_sw_async_terminar(void) {
+    i2c_sw_transaccion_t *transaccion = i2c_sw_async_actual;
+    I2C_SW_SDA_TRIS = 1;
+    I2C_SW_SCL_TRIS = 1;
+    transaccion->estado = i2c_sw_async_estado;
+    transaccion->terminada = true;
+    if(transaccion->aviso)
+        transaccion->aviso(transaccion);
+    i2c_sw_async_siguiente();
+}
+
+/**
+ * @brief Función interna que libera SCL y verifica que haya subido. Si un esclavo la retiene (clock stretching) se reintenta en la
+ * siguiente interrupción, hasta I2C_SW_ASYNC_ESPERA_STRETCH interrupciones (sin límite si I2C_SW_STRETCH_US es 0); después la
+ * transacción termina con I2C_SW_TIMEOUT.
+ * @param (void)
+ * @return (bool) true si SCL está en alto
+*/
+static bool i2c_sw_async_liberarSCL(void) {
+    I2C_SW_SCL_TRIS = 1;
+    if(I2C_SW_SCL_PIN) {
+        i2c_sw_async_espera = 0;
+        return true;
+    }
+    if(I2C_SW_ASYNC_ESPERA_STRETCH && ++i2c_sw_async_espera > I2C_SW_ASYNC_ESPERA_STRETCH) {
+        i2c_sw_async_estado = I2C_SW_TIMEOUT;
+        i2c_sw_async_terminar();
+    }
+    return false;
+}
+
+/**
+ * @brief Función interna que coloca en SDA el siguiente bit del byte en curso (SCL en bajo). En lectura libera la línea.
+ * @param (void)
+ * @return (void)
+*/
+static void i2c_sw_async_colocarBit(void) {
+    if(i2c_sw_async_tipo == I2C_SW_ASYNC_DATO_R || (i2c_sw_async_dato & 0x80)) {
+        SW_SDA_1
+    } else {
+        SW_SDA_0
+    }
+}
+
+/**
+ * @brief Función para agregar una transacción a la cola sin esperar. Si el motor está inactivo arranca el temporizador.
+ * Puede llamarse desde la función de aviso de otra transacción.
+ * @param transaccion (i2c_sw_transaccion_t *): Descriptor de la transacción, válido hasta que termine
+ * @return (bool) true si se encoló, false si la cola está llena
+*/
+bool i2c_sw_async_encolar(i2c_sw_transaccion_t *transaccion) {
+    uint8_t siguiente = (i2c_sw_async_cabeza + 1) & I2C_SW_ASYNC_MASCARA;
+    if(siguiente == i2c_sw_async_cola)
+        return false;
+    transaccion->estado = I2C_SW_OK;
+    transaccion->terminada = false;
+    i2c_sw_async_buffer[i2c_sw_async_cabeza] = transaccion;
+    i2c_sw_async_cabeza = siguiente;
+    if(i2c_sw_async_fase == I2C_SW_ASYNC_INACTIVO) {    //Con el temporizador detenido la interrupción no puede intervenir
+        i2c_sw_async_siguiente();
+        I2C_SW_ASYNC_TIMER_INICIAR(I2C_SW_ASYNC_CICLOS_TICK);
+    }
+    return true;
+}
+
+/**
+ * @brief Función que indica si hay transacciones en curso o en cola
+ * @param (void)
+ * @return (bool) true si el motor de transacciones está activo
+*/
+bool i2c_sw_async_ocupado() {
+    return i2c_sw_async_fase != I2C_SW_ASYNC_INACTIVO;
+}
+
+/**
+ * @brief Rutina a llamar desde la interrupción del temporizador, con periodo I2C_SW_ASYNC_CICLOS_TICK: ejecuta una fase del bus
+ * de la transacción en curso
+ * @param (void)
+ * @return (void)
+*/
+void i2c_sw_async_isr() {
+    i2c_sw_transaccion_t *transaccion = i2c_sw_async_actual;
+    I2C_SW_ASYNC_TIMER_RECARGAR(I2C_SW_ASYNC_CICLOS_TICK);
+    switch(i2c_sw_async_fase) {
+    case I2C_SW_ASYNC_START:
+        SW_SDA_1
+        I2C_SW_SCL_TRIS = 1;
+        if(!I2C_SW_SCL_PIN || !I2C_SW_SDA_PIN) {    //Bus ocupado o SDA retenida por un esclavo (ver i2c_sw_recuperarBus())
+#ifdef I2C_SW_MULTI_MAESTRO
+            i2c_sw_async_libre = 0;
+#endif
+            if(I2C_SW_ASYNC_ESPERA_STRETCH && ++i2c_sw_async_espera > I2C_SW_ASYNC_ESPERA_STRETCH) {
+                i2c_sw_async_estado = I2C_SW_BUS_OCUPADO;
+                i2c_sw_async_terminar();
+            }
+            break;
+        }
+#ifdef I2C_SW_MULTI_MAESTRO
+        if(!i2c_sw_async_reinicio && ++i2c_sw_async_libre < I2C_SW_ASYNC_ESPERA_LIBRE)
+            break;
+#endif
+        i2c_sw_async_espera = 0;
+        SW_SDA_0
+        i2c_sw_async_fase = I2C_SW_ASYNC_START_SCL;
+        break;
+    case I2C_SW_ASYNC_START_SCL:
+        SW_SCL_0
+        if(i2c_sw_async_reinicio || (!transaccion->len_escritura && transaccion->len_lectura)) {
+            i2c_sw_async_tipo = I2C_SW_ASYNC_DIR_R;
+            i2c_sw_async_dato = (transaccion->direccion<<1) | 0x01;
+        } else {
+            i2c_sw_async_tipo = I2C_SW_ASYNC_DIR_W;
+            i2c_sw_async_dato = transaccion->direccion<<1;
+        }
+        i2c_sw_async_reinicio = false;
+        i2c_sw_async_indice = 0;
+        i2c_sw_async_bit = 0;
+        i2c_sw_async_colocarBit();
+        i2c_sw_async_fase = I2C_SW_ASYNC_BIT_ALTO;
+        break;
+    case I2C_SW_ASYNC_BIT_BAJO:
+        SW_SCL_0
+        i2c_sw_async_colocarBit();
+        i2c_sw_async_fase = I2C_SW_ASYNC_BIT_ALTO;
+        break;
+    case I2C_SW_ASYNC_BIT_ALTO:
+        if(!i2c_sw_async_liberarSCL())
+            break;
+        if(i2c_sw_async_tipo == I2C_SW_ASYNC_DATO_R) {
+            i2c_sw_async_dato = (i2c_sw_async_dato<<1) | I2C_SW_SDA_PIN;
+        } else {
+#ifdef I2C_SW_MULTI_MAESTRO
+            if((i2c_sw_async_dato & 0x80) && !I2C_SW_SDA_PIN) {     //Otro maestro mantiene SDA en bajo
+                i2c_sw_async_estado = I2C_SW_ARBITRAJE_PERDIDO;
+                i2c_sw_async_terminar();
+                break;
+            }
+#endif
+            i2c_sw_async_dato <<= 1;
+        }
+        i2c_sw_async_fase = (++i2c_sw_async_bit == 8)? I2C_SW_ASYNC_ACK_BAJO : I2C_SW_ASYNC_BIT_BAJO;
+        break;
+    case I2C_SW_ASYNC_ACK_BAJO:
+        SW_SCL_0
+        if(i2c_sw_async_tipo == I2C_SW_ASYNC_DATO_R) {
+            transaccion->lectura[i2c_sw_async_indice++] = i2c_sw_async_dato;
+            if(i2c_sw_async_indice < transaccion->len_lectura) {
+                SW_SDA_0    //ACK: el esclavo continúa
+            } else {
+                SW_SDA_1    //NACK en el último byte
+            }
+        } else {
+            SW_SDA_1        //Libera SDA para el ACK del esclavo
+        }
+        i2c_sw_async_fase = I2C_SW_ASYNC_ACK_ALTO;
+        break;
+    case I2C_SW_ASYNC_ACK_ALTO:
+        if(!i2c_sw_async_liberarSCL())
+            break;
+        i2c_sw_async_bit = 0;
+        if(i2c_sw_async_tipo == I2C_SW_ASYNC_DATO_R) {
+#ifdef I2C_SW_MULTI_MAESTRO
+            if(i2c_sw_async_indice == transaccion->len_lectura && !I2C_SW_SDA_PIN) {   //Otro maestro envía ACK
+                i2c_sw_async_estado = I2C_SW_ARBITRAJE_PERDIDO;
+                i2c_sw_async_terminar();
+                break;
+            }
+#endif
+            i2c_sw_async_fase = (i2c_sw_async_indice < transaccion->len_lectura)? I2C_SW_ASYNC_BIT_BAJO : I2C_SW_ASYNC_STOP_BAJO;
+        } else if(I2C_SW_SDA_PIN) {
+            i2c_sw_async_estado = I2C_SW_NACK;
+            i2c_sw_async_fase = I2C_SW_ASYNC_STOP_BAJO;
+        } else if(i2c_sw_async_tipo == I2C_SW_ASYNC_DIR_R) {
+            i2c_sw_async_tipo = I2C_SW_ASYNC_DATO_R;
+            i2c_sw_async_indice = 0;
+            i2c_sw_async_fase = I2C_SW_ASYNC_BIT_BAJO;
+        } else if(i2c_sw_async_indice < transaccion->len_escritura) {
+            i2c_sw_async_tipo = I2C_SW_ASYNC_DATO_W;
+            i2c_sw_async_dato = transaccion->escritura[i2c_sw_async_indice++];
+            i2c_sw_async_fase = I2C_SW_ASYNC_BIT_BAJO;
+        } else if(transaccion->len_lectura) {
+            i2c_sw_async_reinicio = true;
+            i2c_sw_async_fase = (transaccion->banderas & I2C_SW_ASYNC_STOP_START)? I2C_SW_ASYNC_STOP_BAJO : I2C_SW_ASYNC_RESTART_BAJO;
+        } else {
+            i2c_sw_async_fase = I2C_SW_ASYNC_STOP_BAJO;
+        }
+        break;
+    case I2C_SW_ASYNC_RESTART_BAJO:
+        SW_SCL_0
+        SW_SDA_1
+        i2c_sw_async_fase = I2C_SW_ASYNC_RESTART_ALTO;
+        break;
+    case I2C_SW_ASYNC_RESTART_ALTO:
+        if(i2c_sw_async_liberarSCL())
+            i2c_sw_async_fase = I2C_SW_ASYNC_START;
+        break;
+    case I2C_SW_ASYNC_STOP_BAJO:
+        SW_SCL_0
+        SW_SDA_0
+        i2c_sw_async_fase = I2C_SW_ASYNC_STOP_ALTO;
+        break;
+    case I2C_SW_ASYNC_STOP_ALTO:
+        if(i2c_sw_async_liberarSCL())
+            i2c_sw_async_fase = I2C_SW_ASYNC_STOP_SDA;
+        break;
+    case I2C_SW_ASYNC_STOP_SDA:
+        SW_SDA_1
+        i2c_sw_async_fase = I2C_SW_ASYNC_LIBRE;
+        break;
+    case I2C_SW_ASYNC_LIBRE:
+        if(i2c_sw_async_reinicio)   //STOP y START entre escritura y lectura
+            i2c_sw_async_fase = I2C_SW_ASYNC_START;
+        else
+            i2c_sw_async_terminar();
+        break;
+    default:
+        I2C_SW_ASYNC_TIMER_DETENER();
+        break;
+    }
+}
+#endif
+
 /**
  * @brief Función de configuración de modo i2c por software, en la que los pines SDA y SCL son configurados como entradas, cuyo estado lógico
  * default es alto por los resistores pullup, simulando terminales de colector/drenaje abierto (open-collector u open-drain).
@@ -125,8 +539,167 @@ uint8_t i2c_sw_readByte(bool ack) {
 void i2c_sw_init() {
     I2C_SW_SDA_TRIS = 1;
     I2C_SW_SCL_TRIS = 1;
+#ifdef I2C_SW_ASYNC
+    I2C_SW_ASYNC_TIMER_DETENER();
+    i2c_sw_async_cabeza = i2c_sw_async_cola = 0;
+    i2c_sw_async_fase = I2C_SW_ASYNC_INACTIVO;
+#endif
 }
+
+/*
+	Lazo de bytes de writeRegs y readRegs. Al entrar (SCL en bajo) se fija en 0 el registro de salida de SCL y luego el de SDA,
+	en ese orden para que la lectura-modificación-escritura del puerto no deje SCL en 1. Dentro del lazo no se escribe el puerto,
+	por lo que ambas líneas se manejan sólo con TRIS: un acceso por cambio en lugar de dos.
+*/
+#define SW_LAZO_INICIAR I2C_SW_SCL_PIN=0;I2C_SW_SDA_PIN=0;
+#define SW_LAZO_SCL_0 I2C_SW_SCL_TRIS=0;
+
+/**
+ * @brief Función para escribir un bloque de registros consecutivos de un dispositivo esclavo: START, dirección (escritura),
+ * número de registro, datos y STOP. La transacción se aborta con STOP ante el primer NACK.
+ * Los datos se envían en un solo lazo, sin una llamada a i2c_sw_writeByte() por byte: SCL queda en bajo al terminar cada ACK y el
+ * siguiente byte comienza sin volver a escribirla.
+ * @param direccion (uint8_t): Dirección de 7 bits del dispositivo esclavo
+ * @param registro (uint8_t): Número del primer registro a escribir
+ * @param datos (const uint8_t *): Datos a escribir
+ * @param len (uint16_t): Cantidad de bytes a escribir
+ * @return (bool) true si el esclavo respondió ACK a todos los bytes, false en caso contrario
+*/
+bool i2c_sw_writeRegs(uint8_t direccion, uint8_t registro, const uint8_t *datos, uint16_t len) {
+    uint8_t i, dato;
+    bool ack;
+    i2c_sw_start();
+    ack = i2c_sw_writeByte(direccion<<1) && i2c_sw_writeByte(registro);
+    if(ack) {
+        SW_LAZO_INICIAR
+    }
+    while(ack && len) {     //SCL en bajo y SDA liberada después del ACK anterior
+        dato = *datos++;
+        len--;
+        for(i=0;i!=8;i++) {
+            I2C_SW_SDA_TRIS = (dato>>7);
+            I2C_SW_ESPERA_LOW()
+            SW_SCL_1
+#ifdef I2C_SW_MULTI_MAESTRO
+            if((dato&0x80) && !I2C_SW_SDA_PIN) {    //Arbitraje perdido: SDA y SCL quedan liberadas, sin STOP
+                i2c_sw_estado = I2C_SW_ARBITRAJE_PERDIDO;
+                return false;
+            }
 #endif
+            I2C_SW_ESPERA_HIGH()
+            SW_LAZO_SCL_0
+            dato<<=1;
+        }
+        SW_SDA_1    //ACK del esclavo
+        I2C_SW_ESPERA_LOW()
+        SW_SCL_1
+        ack = !I2C_SW_SDA_PIN;
+        I2C_SW_ESPERA_HIGH()
+        SW_LAZO_SCL_0
+        if(i2c_sw_estado >= I2C_SW_TIMEOUT)
+            ack = false;
+        else if(!ack)
+            i2c_sw_estado = I2C_SW_NACK;
+    }
+    i2c_sw_stop();
+    return ack;
+}
+
+/**
+ * @brief Función para leer un bloque de registros consecutivos de un dispositivo esclavo: START, dirección (escritura), número de
+ * registro, RESTART, dirección (lectura) y len bytes, con ACK en cada byte excepto el último (NACK), y STOP.
+ * La transacción se aborta con STOP ante el primer NACK del esclavo. Los bytes se leen en un solo lazo, sin una llamada a
+ * i2c_sw_readByte() por byte: SDA permanece liberada entre bytes y sólo se toma para el ACK.
+ * @param direccion (uint8_t): Dirección de 7 bits del dispositivo esclavo
+ * @param registro (uint8_t): Número del primer registro a leer
+ * @param datos (uint8_t *): Arreglo donde se guardan los datos leídos
+ * @param len (uint16_t): Cantidad de bytes a leer
+ * @return (bool) true si el esclavo respondió ACK a la dirección y al registro y la lectura terminó sin error de bus, false en
+ * caso contrario
+*/
+bool i2c_sw_readRegs(uint8_t direccion, uint8_t registro, uint8_t *datos, uint16_t len) {
+    uint8_t i, dato;
+    bool ack;
+    i2c_sw_start();
+    ack = i2c_sw_writeByte(direccion<<1) && i2c_sw_writeByte(registro);
+    if(ack && len) {
+        i2c_sw_restart();
+        ack = i2c_sw_writeByte((direccion<<1)|0x01);
+        if(ack) {
+            SW_LAZO_INICIAR
+        }
+        while(ack && len--) {   //SCL en bajo y SDA liberada después del ACK anterior
+            dato = 0;
+            for(i=0;i!=8;i++) {
+                I2C_SW_ESPERA_LOW()
+                SW_SCL_1
+                dato<<=1;
+                if(I2C_SW_SDA_PIN)
+                    dato|=0x01;
+                I2C_SW_ESPERA_HIGH()
+                SW_LAZO_SCL_0
+            }
+            *datos++ = dato;
+            I2C_SW_SDA_TRIS = !len; //ACK: el esclavo continúa con el siguiente registro; NACK en el último byte
+            I2C_SW_ESPERA_LOW()
+            SW_SCL_1
+#ifdef I2C_SW_MULTI_MAESTRO
+            if(!len && !I2C_SW_SDA_PIN) {   //Otro maestro envía ACK mientras éste envía NACK
+                i2c_sw_estado = I2C_SW_ARBITRAJE_PERDIDO;
+                return false;
+            }
+#endif
+            I2C_SW_ESPERA_HIGH()
+            SW_LAZO_SCL_0
+            SW_SDA_1
+            if(i2c_sw_estado >= I2C_SW_TIMEOUT)
+                ack = false;
+        }
+    }
+    i2c_sw_stop();
+    return ack;
+}
+
+/**
+ * @brief Función que obtiene el estado de la última transacción (desde el último START o recuperación del bus)
+ * @param (void)
+ * @return (i2c_sw_estado_t) I2C_SW_OK, I2C_SW_NACK, I2C_SW_TIMEOUT, I2C_SW_BUS_OCUPADO o I2C_SW_ARBITRAJE_PERDIDO
+*/
+i2c_sw_estado_t i2c_sw_getEstado() {
+    return i2c_sw_estado;
+}
+
+/**
+ * @brief Función de recuperación del bus: con SDA liberada genera hasta 9 pulsos de SCL, hasta que el esclavo que la retiene
+ * termine el byte en curso y la libere, y después una condición STOP. Se llama automáticamente desde i2c_sw_start() si SDA está
+ * en bajo; también puede llamarse después de i2c_sw_init() o de un I2C_SW_TIMEOUT.
+ * @param (void)
+ * @return (i2c_sw_estado_t) I2C_SW_OK si el bus quedó libre, I2C_SW_TIMEOUT si SCL sigue retenida o I2C_SW_BUS_OCUPADO si SDA sigue retenida
+*/
+i2c_sw_estado_t i2c_sw_recuperarBus() {
+    uint8_t i;
+    i2c_sw_estado = I2C_SW_OK;
+    SW_SDA_1
+    SW_SCL_1
+    for(i=0;i!=9 && !I2C_SW_SDA_PIN && i2c_sw_estado == I2C_SW_OK;i++) {
+        SW_SCL_0
+        I2C_SW_ESPERA_LOW()
+        SW_SCL_1
+        I2C_SW_ESPERA_HIGH()
+    }
+    if(i2c_sw_estado == I2C_SW_OK) {    //STOP: SDA baja con SCL en bajo y sube con SCL en alto
+        SW_SCL_0
+        SW_SDA_0
+        I2C_SW_ESPERA_LOW()
+        SW_SCL_1
+        I2C_SW_ESPERA_SU_STO()
+        SW_SDA_1
+        I2C_SW_ESPERA_BUF()
+        if(!I2C_SW_SDA_PIN)
+            i2c_sw_estado = I2C_SW_BUS_OCUPADO;
+    }
+    return i2c_sw_estado;
+}
 
 /**
  * @brief Función para escribir un dato entero de 2 bytes en el bus i2c por software
@@ -159,24 +732,353 @@ void i2c_sw_writeInt32(uint32_t dato) {
  * @param dato (float): Dato flotante de 32(24) bits a trasmitir mediante el bus i2c por software
  * @return (void)
 */
-void i2c_hw_writeFloat(float dato) {
+void i2c_sw_writeFloat(float dato) {
     uint8_t i;
     for(i=0;i!=sizeof(float);i++) {
         i2c_sw_writeByte(*((uint8_t *)&dato+i));
     }
 }
+#endif
+
+#if defined(I2C_SW_LANES) && !defined(SLAVE_MODE_SW)
+static uint8_t i2c_sw_lanes_mascara;    //Canales SDA en uso
+
+/*
+	Macros de SDA para todos los canales a la vez. El registro LAT de los canales se mantiene en 0, de modo que
+	TRIS=1 libera la línea (alto por pullup) y TRIS=0 la lleva a bajo.
+*/
+#define SW_SDA_LANES_1 I2C_SW_LANES_TRIS|=i2c_sw_lanes_mascara;
+#define SW_SDA_LANES_0 I2C_SW_LANES_TRIS&=~i2c_sw_lanes_mascara;
+
+/**
+ * @brief Función de configuración del modo i2c multibus. La línea SCL se configura con i2c_sw_init().
+ * @param mascara (uint8_t): Canales SDA a utilizar (bit n = canal n del puerto I2C_SW_LANES_PORT)
+ * @return (void)
+*/
+void i2c_sw_lanes_init(uint8_t mascara) {
+    i2c_sw_lanes_mascara = mascara;
+    I2C_SW_LANES_TRIS |= mascara;
+    I2C_SW_LANES_LAT &= ~mascara;
+}
+
+/**
+ * @brief Función para generar condición START (S) en todos los buses
+ * @param (void)
+ * @return (void)
+*/
+void i2c_sw_lanes_start() {
+    SW_SDA_LANES_1
+    SW_SCL_1
+    I2C_SW_ESPERA_SU_STA()
+    SW_SDA_LANES_0
+    I2C_SW_ESPERA_HD_STA()
+    SW_SCL_0
+}
+
+/**
+ * @brief Función para generar condición STOP (P) en todos los buses
+ * @param (void)
+ * @return (void)
+*/
+void i2c_sw_lanes_stop() {
+    SW_SDA_LANES_0
+    I2C_SW_ESPERA_LOW()
+    SW_SCL_1
+    I2C_SW_ESPERA_SU_STO()
+    SW_SDA_LANES_1
+    I2C_SW_ESPERA_BUF()
+}
+
+/**
+ * @brief Función para generar condición RESTART (Sr) en todos los buses
+ * @param (void)
+ * @return (void)
+*/
+void i2c_sw_lanes_restart() {
+    SW_SDA_LANES_1
+    I2C_SW_ESPERA_LOW()
+    SW_SCL_1
+    I2C_SW_ESPERA_SU_STA()
+    SW_SDA_LANES_0
+    I2C_SW_ESPERA_HD_STA()
+}
+
+/**
+ * @brief Función para escribir un byte distinto en cada bus. Los bytes se transponen en planos de bits antes de generar el reloj,
+ * de modo que cada bit corresponde a una sola escritura al registro TRIS de los canales.
+ * @param datos (const uint8_t *): 8 bytes, datos[n] se transmite por el canal n (se ignoran los canales fuera de la máscara)
+ * @return (uint8_t) Máscara de canales que respondieron con ACK (bit n en 1 = ACK en el canal n)
+*/
+uint8_t i2c_sw_lanes_writeByte(const uint8_t *datos) {
+    uint8_t copia[8], planos[8], i, canal, plano, resto;
+    resto = I2C_SW_LANES_TRIS & ~i2c_sw_lanes_mascara;
+    for(canal=0;canal!=8;canal++)
+        copia[canal] = datos[canal];
+    for(i=0;i!=8;i++) { //Transposición: el plano i contiene el bit (7-i) de cada canal
+        plano = 0;
+        for(canal=8;canal;) {
+            canal--;
+            plano <<= 1;
+            if(copia[canal] & 0x80)
+                plano |= 0x01;
+            copia[canal] <<= 1;
+        }
+        planos[i] = (plano & i2c_sw_lanes_mascara) | resto;   //Bit en 1: SDA liberada (TRIS=1)
+    }
+    for(i=0;i!=8;i++) {
+        SW_SCL_0
+        I2C_SW_LANES_TRIS = planos[i];
+        I2C_SW_ESPERA_LOW()
+        SW_SCL_1
+        I2C_SW_ESPERA_HIGH()
+    }
+    SW_SCL_0
+    SW_SDA_LANES_1  //Libera SDA para que los esclavos respondan ACK
+    I2C_SW_ESPERA_LOW()
+    SW_SCL_1
+    plano = ~I2C_SW_LANES_PORT & i2c_sw_lanes_mascara;   //ACK: SDA en bajo
+    I2C_SW_ESPERA_HIGH()
+    SW_SCL_0
+    return plano;
+}
+
+/**
+ * @brief Función para escribir el mismo byte en todos los buses (p. ej. la dirección común de los dispositivos)
+ * @param dato (uint8_t): Dato de 8 bits a transmitir
+ * @return (uint8_t) Máscara de canales que respondieron con ACK
+*/
+uint8_t i2c_sw_lanes_writeByteAll(uint8_t dato) {
+    uint8_t datos[8], canal;
+    for(canal=0;canal!=8;canal++)
+        datos[canal] = dato;
+    return i2c_sw_lanes_writeByte(datos);
+}
+
+/**
+ * @brief Función para leer un byte de cada bus de manera simultánea. Las muestras de SDA se guardan por bit y se transponen
+ * al final, para no extender el tiempo en alto de SCL.
+ * @param datos (uint8_t *): 8 bytes donde se almacena el byte leído de cada canal, datos[n] para el canal n
+ * @param ack (bool): Bit ACK a enviar en todos los buses (0 = NACK)
+ * @return (void)
+*/
+void i2c_sw_lanes_readByte(uint8_t *datos, bool ack) {
+    uint8_t muestras[8], i, canal, dato;
+    SW_SDA_LANES_1
+    for(i=0;i!=8;i++) {
+        SW_SCL_0
+        I2C_SW_ESPERA_LOW()
+        SW_SCL_1
+        muestras[i] = I2C_SW_LANES_PORT;
+        I2C_SW_ESPERA_HIGH()
+    }
+    SW_SCL_0
+    if(ack==0) //NACK
+        SW_SDA_LANES_1
+    else //ACK
+        SW_SDA_LANES_0
+    I2C_SW_ESPERA_LOW()
+    SW_SCL_1
+    I2C_SW_ESPERA_HIGH()
+    SW_SCL_0
+    SW_SDA_LANES_1
+    for(canal=0;canal!=8;canal++) { //Transposición inversa: el bit (7-i) del canal n está en el bit n de la muestra i
+        dato = 0;
+        for(i=0;i!=8;i++) {
+            dato <<= 1;
+            if(muestras[i] & (1<<canal))
+                dato |= 0x01;
+        }
+        datos[canal] = dato;
+    }
+}
+#endif
 
 #ifdef SLAVE_MODE_SW
+static uint8_t i2c_sw_slave_direccion;          //Dirección de 7 bits
+static volatile uint8_t *i2c_sw_slave_registros;
+static uint8_t i2c_sw_slave_num_registros;
+static uint8_t i2c_sw_slave_puntero;            //Siguiente registro a leer o escribir
+
 /*
-	Aún no implementado
+	Estado del esclavo entre interrupciones
 */
-void i2c_sw_slave()
-{
+#define I2C_SW_SLAVE_LIBRE      0   //Sin transacción propia: espera START
+#define I2C_SW_SLAVE_DIRECCION  1   //Recibiendo el byte de dirección
+#define I2C_SW_SLAVE_ESCRITURA  2   //Recibiendo número de registro o datos
+#define I2C_SW_SLAVE_LECTURA    3   //Enviando datos al maestro
+
+static uint8_t i2c_sw_slave_estado;
+static uint8_t i2c_sw_slave_bit;                //Pulsos de SCL del byte en curso (0 a 9, el noveno es el ACK)
+static uint8_t i2c_sw_slave_dato;               //Registro de corrimiento
+static bool i2c_sw_slave_registro;              //El siguiente byte escrito es el número de registro
+static uint8_t i2c_sw_slave_lineas;             //Niveles de SDA (bit 0) y SCL (bit 1) en la interrupción anterior
 
+#define SW_SLAVE_LINEAS() ((I2C_SW_SCL_PIN<<1) | I2C_SW_SDA_PIN)
+
+/**
+ * @brief Función interna que atiende un flanco de subida de SCL: muestrea el bit del maestro o, en lectura, su ACK
+ * @param sda (uint8_t): Nivel de SDA
+ * @return (void)
+*/
+static void i2c_sw_slave_subidaSCL(uint8_t sda) {
+    if(i2c_sw_slave_bit < 8) {
+        if(i2c_sw_slave_estado != I2C_SW_SLAVE_LECTURA)
+            i2c_sw_slave_dato = (i2c_sw_slave_dato<<1) | sda;
+    } else if(i2c_sw_slave_estado == I2C_SW_SLAVE_LECTURA && sda) {
+        i2c_sw_slave_estado = I2C_SW_SLAVE_LIBRE;   //NACK: el maestro terminó la lectura, sigue STOP o START repetido
+    }
+    i2c_sw_slave_bit++;
 }
-void i2c_sw_slave_write()
-{
 
+/**
+ * @brief Función interna que atiende un flanco de bajada de SCL: coloca el siguiente bit en SDA. Al terminar el octavo bit y al
+ * terminar el ACK retiene SCL en bajo (clock stretching) sólo mientras accede al mapa de registros.
+ * @param (void)
+ * @return (void)
+*/
+static void i2c_sw_slave_bajadaSCL(void) {
+    if(i2c_sw_slave_bit == 8) {         //Inicio del pulso de ACK
+        if(i2c_sw_slave_estado == I2C_SW_SLAVE_LECTURA) {
+            SW_SDA_1                    //Libera SDA para el ACK del maestro
+            return;
+        }
+        if(i2c_sw_slave_estado == I2C_SW_SLAVE_DIRECCION) {
+            if((i2c_sw_slave_dato>>1) == i2c_sw_slave_direccion) {
+                SW_SDA_0
+            } else {
+                i2c_sw_slave_estado = I2C_SW_SLAVE_LIBRE;   //Transacción para otro dispositivo: no se participa
+            }
+            return;
+        }
+        SW_SCL_0                        //Retiene SCL mientras escribe en el mapa de registros
+        if(i2c_sw_slave_registro) {
+            i2c_sw_slave_puntero = i2c_sw_slave_dato;
+            i2c_sw_slave_registro = false;
+            SW_SDA_0
+        } else if(i2c_sw_slave_puntero < i2c_sw_slave_num_registros) {
+            i2c_sw_slave_registros[i2c_sw_slave_puntero++] = i2c_sw_slave_dato;
+            SW_SDA_0
+        }                               //Fuera del mapa de registros: NACK
+        I2C_SW_SCL_TRIS = 1;
+        return;
+    }
+    if(i2c_sw_slave_bit == 9) {         //Fin del pulso de ACK
+        i2c_sw_slave_bit = 0;
+        if(i2c_sw_slave_estado == I2C_SW_SLAVE_DIRECCION) {
+            if(i2c_sw_slave_dato & 0x01) {
+                i2c_sw_slave_estado = I2C_SW_SLAVE_LECTURA;
+            } else {
+                i2c_sw_slave_estado = I2C_SW_SLAVE_ESCRITURA;
+                i2c_sw_slave_registro = true;   //El primer byte escrito es el número de registro
+            }
+        }
+        if(i2c_sw_slave_estado != I2C_SW_SLAVE_LECTURA) {
+            SW_SDA_1
+            return;
+        }
+        SW_SCL_0                        //Retiene SCL mientras lee el siguiente registro del mapa
+        i2c_sw_slave_dato = (i2c_sw_slave_puntero < i2c_sw_slave_num_registros)? i2c_sw_slave_registros[i2c_sw_slave_puntero] : 0xFF;
+        i2c_sw_slave_puntero++;
+    } else if(i2c_sw_slave_estado != I2C_SW_SLAVE_LECTURA) {
+        return;
+    }
+    if(i2c_sw_slave_dato & 0x80) {
+        SW_SDA_1
+    } else {
+        SW_SDA_0
+    }
+    i2c_sw_slave_dato<<=1;
+    I2C_SW_SCL_TRIS = 1;
+}
+
+/**
+ * @brief Función de configuración del modo esclavo: libera SDA y SCL y habilita las interrupciones por flanco de SDA y SCL
+ * @param direccion (uint8_t): Dirección de 7 bits del esclavo
+ * @param registros (volatile uint8_t *): Mapa de registros que el maestro lee y escribe
+ * @param num_registros (uint8_t): Tamaño del mapa de registros
+ * @return (void)
+*/
+void i2c_sw_slave_init(uint8_t direccion, volatile uint8_t *registros, uint8_t num_registros) {
+    i2c_sw_slave_direccion = direccion;
+    i2c_sw_slave_registros = registros;
+    i2c_sw_slave_num_registros = num_registros;
+    i2c_sw_slave_puntero = 0;
+    i2c_sw_slave_estado = I2C_SW_SLAVE_LIBRE;
+    I2C_SW_SDA_TRIS = 1;
+    I2C_SW_SCL_TRIS = 1;
+    i2c_sw_slave_lineas = SW_SLAVE_LINEAS();
+    I2C_SW_SLAVE_FLANCO_ARMAR(i2c_sw_slave_lineas & 0x01, i2c_sw_slave_lineas>>1)
+    I2C_SW_SLAVE_FLANCO_HABILITAR()
+}
+
+/**
+ * @brief Rutina a llamar desde las interrupciones por flanco de SDA y de SCL. Atiende sólo los flancos ocurridos desde la llamada
+ * anterior (un bit del byte en curso, START o STOP) y regresa; el estado de la transacción se conserva entre interrupciones.
+ * Con SCL en alto, un cambio de SDA es START (bajada) o STOP (subida). SCL se retiene en bajo sólo al inicio y al final del pulso
+ * de ACK, mientras se compara la dirección o se accede al mapa de registros. Cada flanco de SCL debe atenderse antes del siguiente
+ * (latencia de la interrupción más esta rutina menor que tLOW y tHIGH del maestro); un flanco perdido afecta sólo a la transacción
+ * en curso, que se descarta en el siguiente START o STOP.
+ * @param (void)
+ * @return (void)
+*/
+void i2c_sw_slave() {
+    uint8_t lineas, cambios, actual;
+    lineas = SW_SLAVE_LINEAS();
+    for(;;) {
+        //Las interrupciones se arman para el flanco contrario a los niveles leídos y las líneas se vuelven a leer después:
+        //un flanco ocurrido entre la lectura y el armado se detecta en la segunda lectura en lugar de perderse.
+        I2C_SW_SLAVE_FLANCO_ARMAR(lineas & 0x01, lineas>>1)
+        cambios = lineas ^ i2c_sw_slave_lineas;
+        i2c_sw_slave_lineas = lineas;
+        if(cambios & 0x02) {
+            if(i2c_sw_slave_estado != I2C_SW_SLAVE_LIBRE) {
+                if(lineas & 0x02)
+                    i2c_sw_slave_subidaSCL(lineas & 0x01);
+                else
+                    i2c_sw_slave_bajadaSCL();
+            }
+        } else if(cambios && (lineas & 0x02)) {    //SDA cambió con SCL en alto
+            SW_SDA_1
+            i2c_sw_slave_bit = 0;
+            i2c_sw_slave_estado = (lineas & 0x01)? I2C_SW_SLAVE_LIBRE : I2C_SW_SLAVE_DIRECCION;
+        }
+        actual = SW_SLAVE_LINEAS();
+        if(actual == lineas)
+            return;
+        lineas = actual;
+    }
+}
+
+/**
+ * @brief Función que indica si hay una transacción dirigida a este esclavo en curso (de la dirección hasta el STOP, START repetido
+ * o NACK final). Una transacción abarca varias interrupciones: los valores de varios bytes del mapa se actualizan cuando no lo está,
+ * con las interrupciones de flanco deshabilitadas, para que el maestro no lea una mezcla de valores.
+ * @param (void)
+ * @return (bool) true si hay una transacción propia en curso
+*/
+bool i2c_sw_slave_ocupado() {
+    return i2c_sw_slave_estado != I2C_SW_SLAVE_LIBRE;
+}
+
+/**
+ * @brief Función para actualizar un registro del mapa (p. ej. telemetría que el maestro lee). Ver i2c_sw_slave_ocupado() para
+ * valores de varios bytes.
+ * @param registro (uint8_t): Número de registro
+ * @param dato (uint8_t): Valor del registro
+ * @return (void)
+*/
+void i2c_sw_slave_write(uint8_t registro, uint8_t dato) {
+    if(registro < i2c_sw_slave_num_registros)
+        i2c_sw_slave_registros[registro] = dato;
+}
+
+/**
+ * @brief Función para leer un registro del mapa (p. ej. un valor escrito por el maestro)
+ * @param registro (uint8_t): Número de registro
+ * @return (uint8_t) Valor del registro, 0xFF si está fuera del mapa
+*/
+uint8_t i2c_sw_slave_read(uint8_t registro) {
+    return (registro < i2c_sw_slave_num_registros)? i2c_sw_slave_registros[registro] : 0xFF;
 }
 #endif
 
@@ -9,7 +9,11 @@
 #define	I2C_SW_H
 
 /**
- * Utilización de modalidad i2c por software (aún no implementada)
+ * Modo esclavo i2c por software, por interrupción. i2c_sw_slave() se llama desde las interrupciones por flanco de SDA y de SCL y
+ * atiende un bit, START o STOP por llamada; el estado de la transacción se conserva entre interrupciones, por lo que no bloquea
+ * a las demás interrupciones durante la transacción. Sirve lecturas y escrituras sobre un mapa de registros con puntero
+ * autoincrementable (el primer byte escrito es el número de registro) y retiene SCL en bajo sólo mientras accede al mapa, una vez
+ * por byte. La latencia de la interrupción más la rutina debe ser menor que tLOW y tHIGH del maestro. Excluye las funciones de maestro.
 */
 //#define SLAVE_MODE_SW
 
@@ -28,12 +32,188 @@
 #define I2C_SW_SCL_TRIS TRISBbits.TRISB1
 #endif
 
+/**
+ * Perfiles de temporización i2c. El retardo de cada fase se calcula en tiempo de compilación a partir de _XTAL_FREQ, con los mínimos
+ * de la especificación i2c para el modo elegido, descontando el costo estimado de las instrucciones de cada fase (I2C_SW_CICLOS_FASE).
+ * tHIGH se extiende lo necesario para no superar la frecuencia máxima de SCL del modo (tLOW + tHIGH >= 1/fSCL).
+ * Si el retardo calculado no es positivo, la fase se ejecuta tan rápido como lo permite el CPU.
+*/
+#define I2C_SW_STANDARD     0   //Standard-mode, 100 kHz
+#define I2C_SW_FAST         1   //Fast-mode, 400 kHz
+#define I2C_SW_FAST_PLUS    2   //Fast-mode Plus, 1 MHz
+
+#ifndef I2C_SW_SPEED
+#define I2C_SW_SPEED I2C_SW_STANDARD
+#endif
+
+#if I2C_SW_SPEED == I2C_SW_FAST_PLUS
+	#define I2C_SW_T_LOW_NS     500     //Tiempo en bajo de SCL
+	#define I2C_SW_T_HIGH_NS    500     //Tiempo en alto de SCL (mínimo de la especificación: 260 ns)
+	#define I2C_SW_T_SU_STA_NS  260     //Preparación de START repetido
+	#define I2C_SW_T_HD_STA_NS  260     //Retención de START
+	#define I2C_SW_T_SU_STO_NS  260     //Preparación de STOP
+	#define I2C_SW_T_BUF_NS     500     //Bus libre entre STOP y START
+#elif I2C_SW_SPEED == I2C_SW_FAST
+	#define I2C_SW_T_LOW_NS     1300
+	#define I2C_SW_T_HIGH_NS    1200    //Mínimo de la especificación: 600 ns
+	#define I2C_SW_T_SU_STA_NS  600
+	#define I2C_SW_T_HD_STA_NS  600
+	#define I2C_SW_T_SU_STO_NS  600
+	#define I2C_SW_T_BUF_NS     1300
+#else
+	#define I2C_SW_T_LOW_NS     4700
+	#define I2C_SW_T_HIGH_NS    5300    //Mínimo de la especificación: 4000 ns
+	#define I2C_SW_T_SU_STA_NS  4700
+	#define I2C_SW_T_HD_STA_NS  4000
+	#define I2C_SW_T_SU_STO_NS  4000
+	#define I2C_SW_T_BUF_NS     4700
+#endif
+
+#ifndef I2C_SW_CICLOS_FASE
+#define I2C_SW_CICLOS_FASE  6   //Ciclos de instrucción estimados por fase sin retardos (manejo de pines y lazo)
+#endif
+
+//Ciclos de instrucción para un tiempo en ns, redondeado hacia arriba, y retardo de la fase descontando su costo
+#define I2C_SW_CICLOS_NS(ns)    ((((ns)*(_XTAL_FREQ/4000UL))+999999UL)/1000000UL)
+#define I2C_SW_RETARDO_NS(ns)   ((I2C_SW_CICLOS_NS(ns) > I2C_SW_CICLOS_FASE)? (I2C_SW_CICLOS_NS(ns)-I2C_SW_CICLOS_FASE) : 0)
+
+/**
+ * Espera máxima de clock stretching. Después de liberar SCL el maestro espera a lo más I2C_SW_STRETCH_US microsegundos a que la
+ * línea suba; si no sube, la transacción termina con I2C_SW_TIMEOUT (ver i2c_sw_getEstado()) y el resto de sus fases se ejecuta
+ * sin esperar. Con 0 la espera es indefinida. Ajustar I2C_SW_CICLOS_STRETCH al costo real del lazo si se requiere precisión.
+*/
+#ifndef I2C_SW_STRETCH_US
+#define I2C_SW_STRETCH_US       10000UL     //10 ms
+#endif
+#ifndef I2C_SW_CICLOS_STRETCH
+#define I2C_SW_CICLOS_STRETCH   8           //Ciclos de instrucción por iteración del lazo de espera de SCL
+#endif
+#define I2C_SW_ESPERA_STRETCH   ((I2C_SW_STRETCH_US*(_XTAL_FREQ/4000UL))/(1000UL*I2C_SW_CICLOS_STRETCH))    //En iteraciones
+
+/**
+ * Estado de la última transacción. A partir de I2C_SW_TIMEOUT el bus no es utilizable: writeByte devuelve false sin generar
+ * pulsos de reloj hasta el siguiente START.
+*/
+typedef enum {
+    I2C_SW_OK = 0,          //Transacción completa
+    I2C_SW_NACK,            //El esclavo respondió NACK
+    I2C_SW_TIMEOUT,         //SCL retenida en bajo más de I2C_SW_STRETCH_US
+    I2C_SW_BUS_OCUPADO,     //SDA retenida en bajo aun después de la secuencia de recuperación, o bus sin liberar (multimaestro)
+    I2C_SW_ARBITRAJE_PERDIDO    //Otro maestro ganó el bus (multimaestro)
+} i2c_sw_estado_t;
+
+/**
+ * Modo multimaestro: en cada bit que el maestro deja en 1 se lee SDA de regreso con SCL en alto; si otro maestro la mantiene en
+ * bajo se pierde el arbitraje, se liberan ambas líneas sin generar STOP y la transacción termina con I2C_SW_ARBITRAJE_PERDIDO.
+ * i2c_sw_start() espera a que SDA y SCL permanezcan en alto I2C_SW_LIBRE_US microsegundos (bus libre) antes de generar START;
+ * si no ocurre dentro de I2C_SW_STRETCH_US termina con I2C_SW_BUS_OCUPADO. En este modo start no ejecuta la recuperación del
+ * bus, ya que SDA en bajo puede pertenecer a otro maestro.
+*/
+//#define I2C_SW_MULTI_MAESTRO
+
+#ifndef I2C_SW_LIBRE_US
+#define I2C_SW_LIBRE_US         50UL        //Tiempo de inactividad que define el bus libre (SMBus)
+#endif
+#define I2C_SW_ESPERA_LIBRE     ((I2C_SW_LIBRE_US*(_XTAL_FREQ/4000UL))/(1000UL*I2C_SW_CICLOS_STRETCH) + 1)  //En iteraciones
+
+/**
+ * Modo i2c multibus: hasta 8 líneas SDA en un mismo puerto que comparten la línea SCL. Pensado para dispositivos idénticos con la
+ * misma dirección fija, que se atienden en paralelo en el tiempo de un solo bus. El bit n del puerto corresponde al bus (canal) n.
+*/
+//#define I2C_SW_LANES
+
+#ifndef I2C_SW_LANES_PORT
+#define I2C_SW_LANES_PORT   PORTD
+#define I2C_SW_LANES_LAT    LATD
+#define I2C_SW_LANES_TRIS   TRISD
+#endif
+
+/**
+ * Transacciones en segundo plano: i2c_sw_async_encolar() agrega a una cola el descriptor de una transacción (dirección, bytes a
+ * escribir, bytes a leer, banderas y función de aviso) y regresa de inmediato. La transacción la ejecuta i2c_sw_async_isr(), que
+ * debe llamarse desde la interrupción de un temporizador y avanza una fase del bus (medio periodo de SCL) por llamada; el
+ * temporizador se arranca al encolar y se detiene con la cola vacía. Cada transacción genera START, dirección y los bytes a
+ * escribir; si hay bytes a leer sigue RESTART (o STOP y START con I2C_SW_ASYNC_STOP_START), dirección de lectura y los bytes con
+ * NACK en el último; termina con STOP. El descriptor debe permanecer válido hasta que termine. Las funciones bloqueantes no deben
+ * usarse mientras i2c_sw_async_ocupado() sea verdadero.
+*/
+//#define I2C_SW_ASYNC
+
+#ifndef I2C_SW_ASYNC_COLA_SIZE
+#define I2C_SW_ASYNC_COLA_SIZE      4       //Transacciones en cola, potencia de 2 (máximo 256)
+#endif
+
+/**
+ * Periodo de la interrupción del motor de transacciones: el mayor de tLOW y tHIGH del perfil I2C_SW_SPEED, sin bajar de
+ * I2C_SW_ASYNC_CICLOS_MINIMO, que debe cubrir la duración de i2c_sw_async_isr() más la entrada y salida de la interrupción.
+ * Con cristales lentos SCL resulta más lenta que el perfil.
+*/
+#ifndef I2C_SW_ASYNC_CICLOS_MINIMO
+#define I2C_SW_ASYNC_CICLOS_MINIMO  80
+#endif
+#ifndef I2C_SW_ASYNC_CICLOS_TICK
+#if I2C_SW_T_LOW_NS > I2C_SW_T_HIGH_NS
+#define I2C_SW_ASYNC_CICLOS_FASE    I2C_SW_CICLOS_NS(I2C_SW_T_LOW_NS)
+#else
+#define I2C_SW_ASYNC_CICLOS_FASE    I2C_SW_CICLOS_NS(I2C_SW_T_HIGH_NS)
+#endif
+#define I2C_SW_ASYNC_CICLOS_TICK    ((I2C_SW_ASYNC_CICLOS_FASE > I2C_SW_ASYNC_CICLOS_MINIMO)? I2C_SW_ASYNC_CICLOS_FASE : I2C_SW_ASYNC_CICLOS_MINIMO)
+#endif
+#define I2C_SW_ASYNC_ESPERA_STRETCH ((I2C_SW_STRETCH_US*(_XTAL_FREQ/4000UL))/(1000UL*I2C_SW_ASYNC_CICLOS_TICK))     //En interrupciones
+#define I2C_SW_ASYNC_ESPERA_LIBRE   ((I2C_SW_LIBRE_US*(_XTAL_FREQ/4000UL))/(1000UL*I2C_SW_ASYNC_CICLOS_TICK) + 1)   //En interrupciones
+
+/**
+ * Control del temporizador del motor de transacciones. Por defecto se usa TMR1 (preescalador 1:1), el mismo que la recepción en
+ * segundo plano de serial_sw; si se usan ambos, redefinir uno de ellos antes de incluir este archivo.
+*/
+#ifndef I2C_SW_ASYNC_TIMER_INICIAR
+#define I2C_SW_ASYNC_TIMER_INICIAR(ciclos)  {T1CONbits.TMR1ON=0;TMR1=(uint16_t)(65536UL-(ciclos));PIR1bits.TMR1IF=0;PIE1bits.TMR1IE=1;T1CONbits.TMR1ON=1;}
+#define I2C_SW_ASYNC_TIMER_RECARGAR(ciclos) {TMR1+=(uint16_t)(65536UL-(ciclos));}	//Recarga sin acumular la latencia de la interrupción
+#define I2C_SW_ASYNC_TIMER_DETENER()        {T1CONbits.TMR1ON=0;PIE1bits.TMR1IE=0;}
+#endif
+
+/*
+	Banderas de transacción
+*/
+#define I2C_SW_ASYNC_STOP_START     0x01    //STOP y START entre escritura y lectura en lugar de RESTART
+
+/**
+ * Descriptor de transacción en segundo plano. estado y terminada los actualiza el motor; la función de aviso (opcional) se
+ * ejecuta dentro de la interrupción al terminar y puede encolar otra transacción.
+*/
+typedef struct i2c_sw_transaccion {
+    uint8_t direccion;                  //Dirección de 7 bits del dispositivo esclavo
+    uint8_t banderas;                   //I2C_SW_ASYNC_x
+    const uint8_t *escritura;           //Bytes a escribir (p. ej. número de registro)
+    uint16_t len_escritura;
+    uint8_t *lectura;                   //Destino de los bytes leídos
+    uint16_t len_lectura;
+    void (*aviso)(struct i2c_sw_transaccion *transaccion);     //NULL si no se requiere
+    void *contexto;                     //Libre para la aplicación
+    volatile i2c_sw_estado_t estado;    //I2C_SW_OK, I2C_SW_NACK, I2C_SW_TIMEOUT, I2C_SW_BUS_OCUPADO o I2C_SW_ARBITRAJE_PERDIDO
+    volatile bool terminada;
+} i2c_sw_transaccion_t;
+
+/**
+ * Control de las interrupciones por flanco del modo esclavo. Por defecto SDA usa INT0 (RB0) y SCL usa INT1 (RB1), los pines por
+ * defecto; como cada una detecta un solo flanco, I2C_SW_SLAVE_FLANCO_ARMAR selecciona el flanco contrario al nivel actual de cada
+ * línea y limpia las banderas. Pueden redefinirse antes de incluir este archivo (p. ej. interrupción por cambio de RB4-RB7).
+*/
+#ifndef I2C_SW_SLAVE_FLANCO_HABILITAR
+#define I2C_SW_SLAVE_FLANCO_HABILITAR()         {INTCONbits.INT0IE=1;INTCON3bits.INT1IE=1;}
+#define I2C_SW_SLAVE_FLANCO_ARMAR(sda,scl)      {INTCON2bits.INTEDG0=!(sda);INTCON2bits.INTEDG1=!(scl);INTCONbits.INT0IF=0;INTCON3bits.INT1IF=0;}
+#endif
+
 /*
 	Definición de macros para las distintas configuraciones posibles en el modo i2c por software
 */
 #define SW_SDA_1 I2C_SW_SDA_TRIS=1;
 #define SW_SDA_0 I2C_SW_SDA_TRIS=0;I2C_SW_SDA_PIN=0;
+#if I2C_SW_STRETCH_US
+#define SW_SCL_1 I2C_SW_SCL_TRIS=1;if(!I2C_SW_SCL_PIN){i2c_sw_esperarSCL();} //Clock stretching con espera acotada
+#else
 #define SW_SCL_1 I2C_SW_SCL_TRIS=1;while(!I2C_SW_SCL_PIN){} //Prueba clock stretching
+#endif
 #define SW_SCL_0 I2C_SW_SCL_TRIS=0;I2C_SW_SCL_PIN=0;
 
 /*
@@ -47,9 +227,30 @@ uint8_t i2c_sw_readByte(bool ack);
 void i2c_sw_init();
 void i2c_sw_ack();
 void i2c_sw_nack(); 
+bool i2c_sw_writeRegs(uint8_t direccion, uint8_t registro, const uint8_t *datos, uint16_t len);
+bool i2c_sw_readRegs(uint8_t direccion, uint8_t registro, uint8_t *datos, uint16_t len);
+i2c_sw_estado_t i2c_sw_getEstado();
+i2c_sw_estado_t i2c_sw_recuperarBus();
+#ifdef I2C_SW_LANES
+void i2c_sw_lanes_init(uint8_t mascara);
+void i2c_sw_lanes_start();
+void i2c_sw_lanes_stop();
+void i2c_sw_lanes_restart();
+uint8_t i2c_sw_lanes_writeByte(const uint8_t *datos);
+uint8_t i2c_sw_lanes_writeByteAll(uint8_t dato);
+void i2c_sw_lanes_readByte(uint8_t *datos, bool ack);
+#endif
+#ifdef I2C_SW_ASYNC
+bool i2c_sw_async_encolar(i2c_sw_transaccion_t *transaccion);
+bool i2c_sw_async_ocupado();
+void i2c_sw_async_isr();
+#endif
 #ifdef SLAVE_MODE_SW
+void i2c_sw_slave_init(uint8_t direccion, volatile uint8_t *registros, uint8_t num_registros);
 void i2c_sw_slave();
-void i2c_sw_slave_write();
+bool i2c_sw_slave_ocupado();
+void i2c_sw_slave_write(uint8_t registro, uint8_t dato);
+uint8_t i2c_sw_slave_read(uint8_t registro);
 #endif
 
 
@@ -58,10 +259,10 @@ void i2c_sw_slave_write();
  * 24 bits (al parecer en un formato minifloat) o de 32 bits (Estándar IEEE 754 para precisión simple)
 */
 #ifdef i2c_sw_INT16_TX
-void i2c_sw_writeInt16(int16_t dato);
+void i2c_sw_writeInt16(uint16_t dato);
 #endif
 #ifdef i2c_sw_INT32_TX
-void i2c_sw_writeInt32(int32_t dato);
+void i2c_sw_writeInt32(uint32_t dato);
 #endif
 #ifdef i2c_sw_FLOAT_TX
 void i2c_sw_writeFloat(float dato);
@@ -10,6 +10,205 @@
 #include "../../utils/utils.h"
 #include "serial_sw.h"
 
+#ifdef SERIAL_SW_TX_ISR
+#if (SERIAL_SW_TX_BUFFER_SIZE & (SERIAL_SW_TX_BUFFER_SIZE-1)) || SERIAL_SW_TX_BUFFER_SIZE > 256
+#error "SERIAL_SW_TX_BUFFER_SIZE debe ser potencia de 2 y no mayor a 256"
+#endif
+#define SERIAL_SW_TX_MASCARA  (SERIAL_SW_TX_BUFFER_SIZE-1)
+
+/**
+ * Variables internas de transmisión en segundo plano. El programa principal sólo escribe tx_cabeza y la interrupción sólo
+ * escribe tx_cola, por lo que no es necesario deshabilitar interrupciones.
+*/
+static volatile uint8_t tx_buffer[SERIAL_SW_TX_BUFFER_SIZE];
+static volatile uint8_t tx_cabeza;     //Siguiente lugar libre
+static volatile uint8_t tx_cola;       //Siguiente byte a transmitir
+static volatile uint8_t tx_bits;       //Periodos de bit restantes de la trama en curso (0 = línea libre)
+static uint8_t tx_dato;                //Bits de datos pendientes de la trama en curso
+#endif
+
+/**
+ * Verificación de SW_BAUDRATE contra _XTAL_FREQ. Las macros de retardo son sin signo, por lo que se verifica el periodo de bit
+ * antes de que una corrección lo vuelva negativo.
+*/
+#if CYCLES_BIT_PERIOD < SERIAL_SW_PERIODO_MINIMO
+#error "SW_BAUDRATE demasiado alto para la frecuencia _XTAL_FREQ: los retardos por bit resultan negativos"
+#elif SERIAL_SW_ERROR_CENTESIMAS > SERIAL_SW_TOLERANCIA
+#error "El error de velocidad de SW_BAUDRATE con la frecuencia _XTAL_FREQ excede SERIAL_SW_TOLERANCIA"
+#endif
+
+#ifdef SERIAL_SW_VALIDAR_STOP
+/**
+ * Contadores de tramas descartadas
+*/
+static volatile uint16_t serial_sw_errores_trama;
+static volatile uint16_t serial_sw_breaks;
+#endif
+
+#ifdef SERIAL_SW_BAUD_VARIABLE
+#if defined(SERIAL_SW_BIT_FRACCIONAL) || defined(SERIAL_SW_RX_MAYORIA)
+#error "SERIAL_SW_BAUD_VARIABLE no es compatible con SERIAL_SW_BIT_FRACCIONAL ni con SERIAL_SW_RX_MAYORIA"
+#endif
+#if defined(SERIAL_SW_TX_ISR) || defined(SERIAL_SW_RX_ISR)
+#error "SERIAL_SW_BAUD_VARIABLE no es compatible con SERIAL_SW_TX_ISR, SERIAL_SW_RX_ISR ni SERIAL_SW_FULL_DUPLEX (periodo de bit fijo en compilación)"
+#endif
+
+/**
+ * Instantes ideales (en ciclos desde el flanco de START) de cada borde y mitad de bit para un periodo de ciclos/bits, y su
+ * conversión a iteraciones acumuladas de retardo descontando los ciclos fijos ejecutados hasta ese instante
+*/
+#define SERIAL_SW_ITER(instante,fijos) (((instante) < (fijos))? 0 : ((instante)-(fijos)+SERIAL_SW_CICLOS_ITERACION/2)/SERIAL_SW_CICLOS_ITERACION)
+#define SERIAL_SW_ITER_TX(k,ciclos,bits) SERIAL_SW_ITER((2*(uint32_t)(k)*(ciclos)/(bits)+1)/2,(uint32_t)(k)*SERIAL_SW_CORRECCION_TX_BIT)
+#define SERIAL_SW_ITER_RX(k,ciclos,bits) SERIAL_SW_ITER(((2*(uint32_t)(k)+1)*(ciclos)/(bits)+1)/2, \
+    SERIAL_SW_CORRECCION_RX_INICIO+((uint32_t)(k)-1)*SERIAL_SW_CORRECCION_RX_BIT)
+
+/**
+ * Tabla de velocidades precalculada para _XTAL_FREQ. Sólo se incluyen las velocidades cuyo periodo de bit alcanza para las
+ * correcciones y al menos una iteración de retardo.
+*/
+#define SERIAL_SW_BAUD_VALIDO(b) (((_XTAL_FREQ/4)/(b)) >= SERIAL_SW_CORRECCION_TX_BIT+SERIAL_SW_CICLOS_ITERACION && \
+    ((_XTAL_FREQ/4)/(b)) >= SERIAL_SW_CORRECCION_RX_BIT+SERIAL_SW_CICLOS_ITERACION)
+#define SERIAL_SW_TX_K(k,b) (SERIAL_SW_ITER_TX((k)+1,_XTAL_FREQ/4,b)-SERIAL_SW_ITER_TX(k,_XTAL_FREQ/4,b))
+#define SERIAL_SW_RX_K(k,b) (SERIAL_SW_ITER_RX((k)+1,_XTAL_FREQ/4,b)-SERIAL_SW_ITER_RX(k,_XTAL_FREQ/4,b))
+#define SERIAL_SW_VELOCIDAD(b) {b, { \
+    {SERIAL_SW_TX_K(0,b),SERIAL_SW_TX_K(1,b),SERIAL_SW_TX_K(2,b),SERIAL_SW_TX_K(3,b),SERIAL_SW_TX_K(4,b), \
+     SERIAL_SW_TX_K(5,b),SERIAL_SW_TX_K(6,b),SERIAL_SW_TX_K(7,b),SERIAL_SW_TX_K(8,b),SERIAL_SW_TX_K(9,b)}, \
+    {SERIAL_SW_ITER_RX(1,_XTAL_FREQ/4,b),SERIAL_SW_RX_K(1,b),SERIAL_SW_RX_K(2,b),SERIAL_SW_RX_K(3,b),SERIAL_SW_RX_K(4,b), \
+     SERIAL_SW_RX_K(5,b),SERIAL_SW_RX_K(6,b),SERIAL_SW_RX_K(7,b),SERIAL_SW_RX_K(8,b)}}}
+
+typedef struct {
+    uint32_t baud;
+    serial_sw_tiempos_t tiempos;
+} serial_sw_velocidad_t;
+
+static const serial_sw_velocidad_t serial_sw_velocidades[] = {
+#if SERIAL_SW_BAUD_VALIDO(1200UL)
+    SERIAL_SW_VELOCIDAD(1200UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(2400UL)
+    SERIAL_SW_VELOCIDAD(2400UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(4800UL)
+    SERIAL_SW_VELOCIDAD(4800UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(9600UL)
+    SERIAL_SW_VELOCIDAD(9600UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(14400UL)
+    SERIAL_SW_VELOCIDAD(14400UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(19200UL)
+    SERIAL_SW_VELOCIDAD(19200UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(38400UL)
+    SERIAL_SW_VELOCIDAD(38400UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(57600UL)
+    SERIAL_SW_VELOCIDAD(57600UL),
+#endif
+#if SERIAL_SW_BAUD_VALIDO(115200UL)
+    SERIAL_SW_VELOCIDAD(115200UL),
+#endif
+};
+
+/**
+ * Variables internas de velocidad variable. serial_sw_tiempos apunta a una entrada de la tabla o a los tiempos medidos.
+*/
+static serial_sw_tiempos_t serial_sw_tiempos_medidos;
+static const serial_sw_tiempos_t *serial_sw_tiempos;
+static uint32_t serial_sw_baud;        //Velocidad actual en bits por segundo
+static uint32_t serial_sw_espera_trama; //Duración de la recepción de una trama a la velocidad actual, en iteraciones
+
+//Las lecturas con tiempo límite descuentan la duración de la trama a la velocidad actual, no a SW_BAUDRATE
+#undef SERIAL_SW_ESPERA_TRAMA
+#define SERIAL_SW_ESPERA_TRAMA serial_sw_espera_trama
+
+/**
+ * @brief Función interna que selecciona los retardos por bit y calcula con ellos la duración de la recepción de una trama (del
+ * flanco de START a la mitad del STOP) en iteraciones del lazo de espera con tiempo límite
+ * @param tiempos: (const serial_sw_tiempos_t *) Retardos a utilizar
+ * @return (void)
+*/
+static void serial_sw_usarTiempos(const serial_sw_tiempos_t *tiempos) {
+    uint32_t iteraciones = 0;
+    uint8_t k;
+    for(k=0;k!=9;k++)
+        iteraciones += tiempos->rx[k];
+    serial_sw_tiempos = tiempos;
+    serial_sw_espera_trama = (iteraciones*SERIAL_SW_CICLOS_ITERACION + SERIAL_SW_CORRECCION_RX_INICIO +
+        8*SERIAL_SW_CORRECCION_RX_BIT)/SERIAL_SW_CICLOS_ESPERA;
+}
+
+/**
+ * @brief Función interna de retardo variable
+ * @param iteraciones: (uint16_t) Iteraciones de SERIAL_SW_CICLOS_ITERACION ciclos
+ * @return (void)
+*/
+static void serial_sw_retardo(uint16_t iteraciones) {
+    while(iteraciones--)
+        _delay(SERIAL_SW_CICLOS_ITERACION-SERIAL_SW_CICLOS_LAZO);
+}
+
+/**
+ * @brief Función interna que calcula en tiempo de ejecución los retardos de cada bit para un periodo de bit de ciclos/bits
+ * ciclos de instrucción, con las mismas fórmulas que la tabla de velocidades. Cada retardo es la diferencia entre instantes ideales
+ * acumulados, de modo que el residuo fraccional se reparte entre los bits.
+ * @param ciclos: (uint32_t) Ciclos de instrucción de la cantidad de bits indicada
+ * @param bits: (uint32_t) Cantidad de bits (puede ser la velocidad en bits por segundo, con ciclos = _XTAL_FREQ/4)
+ * @return (void)
+*/
+static void serial_sw_calcularTiempos(uint32_t ciclos, uint32_t bits) {
+    uint32_t anterior, actual;
+    uint8_t k;
+    anterior = 0;
+    for(k=1;k!=11;k++) {     //Bordes de los bits 1 a 10 (fin del STOP)
+        actual = SERIAL_SW_ITER_TX(k,ciclos,bits);
+        if(actual < anterior)
+            actual = anterior;
+        serial_sw_tiempos_medidos.tx[k-1] = actual - anterior;
+        anterior = actual;
+    }
+    anterior = 0;
+    for(k=1;k!=10;k++) {     //Mitades de los bits 1 a 9 (STOP)
+        actual = SERIAL_SW_ITER_RX(k,ciclos,bits);
+        if(actual < anterior)
+            actual = anterior;
+        serial_sw_tiempos_medidos.rx[k-1] = actual - anterior;
+        anterior = actual;
+    }
+    serial_sw_usarTiempos(&serial_sw_tiempos_medidos);
+}
+#endif
+
+#ifdef SERIAL_SW_FULL_DUPLEX
+#if SERIAL_SW_OVERSAMPLING < 3
+#error "SERIAL_SW_OVERSAMPLING debe ser al menos 3"
+#endif
+
+/**
+ * Variables internas del modo full duplex
+*/
+static uint8_t fd_tx_ticks;            //Interrupciones restantes del bit en transmisión
+static uint8_t fd_rx_ticks;            //Interrupciones restantes para la siguiente muestra
+static bool fd_rx_inactivo;            //Se observó la línea en alto desde la última trama (el siguiente bajo es un START)
+#endif
+
+#ifdef SERIAL_SW_RX_ISR
+#if (SERIAL_SW_RX_BUFFER_SIZE & (SERIAL_SW_RX_BUFFER_SIZE-1)) || SERIAL_SW_RX_BUFFER_SIZE > 256
+#error "SERIAL_SW_RX_BUFFER_SIZE debe ser potencia de 2 y no mayor a 256"
+#endif
+#define SERIAL_SW_RX_MASCARA  (SERIAL_SW_RX_BUFFER_SIZE-1)
+
+/**
+ * Variables internas de recepción en segundo plano. La interrupción sólo escribe rx_cabeza y el programa principal sólo rx_cola.
+*/
+static volatile uint8_t rx_buffer[SERIAL_SW_RX_BUFFER_SIZE];
+static volatile uint8_t rx_cabeza;     //Siguiente lugar libre
+static volatile uint8_t rx_cola;       //Siguiente byte a entregar
+static uint8_t rx_bits;                //Muestras restantes de la trama en curso (0 = esperando START)
+static uint8_t rx_dato;                //Bits recibidos de la trama en curso
+#endif
+
 /**
   * @brief Función para configurar los pines RX y TX como E/S, y dichos pines se definien en el archivo serial_sw.h.
   * La velocidad de comunicación se define en el archivo serial_sw.h mediante la macro SW_BAUDRATE
@@ -21,14 +220,125 @@ void serial_sw_init() {
   SW_TX_TRIS = 0;
   SW_TX = 1;
   SW_RX_TRIS = 1;
+#ifdef SERIAL_SW_BAUD_VARIABLE
+  if(!serial_sw_setBaud(SW_BAUDRATE)) {
+      serial_sw_calcularTiempos(_XTAL_FREQ/4,SW_BAUDRATE);
+      serial_sw_baud = SW_BAUDRATE;
+  }
+#endif
+#ifdef SERIAL_SW_TX_ISR
+  tx_cabeza = tx_cola = tx_bits = 0;
+#endif
+#ifdef SERIAL_SW_RX_ISR
+  rx_cabeza = rx_cola = rx_bits = 0;
+#endif
+#ifdef SERIAL_SW_FULL_DUPLEX
+  fd_tx_ticks = fd_rx_ticks = 0;
+  fd_rx_inactivo = false;
+#elif defined(SERIAL_SW_RX_ISR)
+  SERIAL_SW_RX_TIMER_DETENER();
+  SERIAL_SW_RX_FLANCO_HABILITAR();
+#endif
+}
+
+#ifdef SERIAL_SW_TX_ISR
+/**
+  * @brief Función que coloca un byte en el buffer de transmisión; espera únicamente si el buffer está lleno
+  * @param dato: (uint8_t) Byte a transmitir 
+  * @return (void)
+*/
+void serial_sw_writeByte(uint8_t dato) {
+  uint8_t siguiente = (tx_cabeza + 1) & SERIAL_SW_TX_MASCARA;
+  while(siguiente == tx_cola)
+      NOP();
+  tx_buffer[tx_cabeza] = dato;
+  tx_cabeza = siguiente;
+}
+
+/**
+  * @brief Rutina de transmisión a llamar desde la interrupción del temporizador, una vez por periodo de bit.
+  * Emite START, 8 bits de datos y STOP; con el buffer vacío la línea permanece en estado inactivo (alto).
+  * En modo full duplex la llama serial_sw_fd_isr().
+  * @param (void)
+  * @return (void)
+*/
+void serial_sw_tx_isr(void) {
+  if(tx_bits) {
+      if(--tx_bits) {
+          if(tx_bits == 1) {
+              SW_TX = 1;                    //STOP
+          } else {
+              SW_TX = tx_dato & 0x01;
+              tx_dato >>= 1;
+          }
+          return;
+      }
+  }
+  //Periodo de STOP cumplido (o línea libre): inicia la siguiente trama, si la hay
+  if(tx_cola != tx_cabeza) {
+      tx_dato = tx_buffer[tx_cola];
+      tx_cola = (tx_cola + 1) & SERIAL_SW_TX_MASCARA;
+      SW_TX = 0;                            //START
+      tx_bits = 10;
+  }
 }
 
+/**
+  * @brief Función que espera a que se hayan transmitido todos los bytes del buffer, incluyendo el bit de STOP del último
+  * @param (void)
+  * @return (void)
+*/
+void serial_sw_flush(void) {
+  while(tx_bits || tx_cola != tx_cabeza)
+      NOP();
+}
+
+/**
+  * @brief Función que obtiene la cantidad de bytes pendientes de transmitir (incluyendo el que está en curso)
+  * @param (void)
+  * @return (uint16_t) Bytes pendientes
+*/
+uint16_t serial_sw_txPending(void) {
+  uint16_t pendientes = (uint8_t)(tx_cabeza - tx_cola) & SERIAL_SW_TX_MASCARA;
+  if(tx_bits)
+      pendientes++;
+  return pendientes;
+}
+#else
 /**
   * @brief Función que transmite un byte vía USART por software 
   * @param dato: (uint8_t) Byte a transmitir 
   * @return (void) retval
 */
 void serial_sw_writeByte(uint8_t dato) {
+#ifdef SERIAL_SW_BIT_FRACCIONAL
+  SW_TX = 0;                            //START
+  _delay(CYCLES_DELAY_TX_FRAC(0));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(1));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(2));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(3));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(4));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(5));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(6));
+  SW_TX = dato & 0x01; dato >>= 1; _delay(CYCLES_DELAY_TX_FRAC(7));
+  SW_TX = dato & 0x01;             _delay(CYCLES_DELAY_TX_FRAC(8));
+  SW_TX = 1;                            //STOP
+  _delay(CYCLES_DELAY_TX_FRAC(9));
+#elif defined(SERIAL_SW_BAUD_VARIABLE)
+  const uint16_t *retardo = serial_sw_tiempos->tx;
+  uint8_t bit_count = 8;
+  //START
+  SW_TX = 0;
+  serial_sw_retardo(*retardo++);
+  while(bit_count--) {
+      SW_TX = dato & 0x01;
+      serial_sw_retardo(*retardo++);
+      dato >>= 1;
+  }
+  //STOP
+  SW_TX = 1;
+  serial_sw_retardo(*retardo);
+#else
   uint8_t bit_count = 8;
   //START
   SW_TX = 0;
@@ -42,19 +352,178 @@ void serial_sw_writeByte(uint8_t dato) {
   //STOP
   SW_TX = 1;
   _delay(CYCLES_DELAY_TX_BIT);
+#endif
 }
+#endif
 
+#ifdef SERIAL_SW_RX_ISR
 /**
-  * @brief Función para recepción de un byte vía USART por software.                       
-  * Importante desactivar interrupciones durante su ejecución para evitar errores de sincronización.
+  * @brief Función interna que procesa la muestra a la mitad de un bit de la trama en recepción.
+  * Una trama con START falso (ruido) o sin STOP válido se descarta, igual que un byte que no cabe en el buffer.
+  * @param nivel: (bool) Nivel de SW_RX muestreado
+  * @return (void)
+*/
+static void serial_sw_rx_muestra(bool nivel) {
+  uint8_t siguiente;
+  if(rx_bits == 10) {                   //START
+      if(nivel)
+          rx_bits = 1;
+  } else if(rx_bits != 1) {             //Bits de datos, del menos al más significativo
+      rx_dato >>= 1;
+      if(nivel)
+          rx_dato |= 0x80;
+  } else {                              //STOP
+      if(nivel) {
+          siguiente = (rx_cabeza + 1) & SERIAL_SW_RX_MASCARA;
+          if(siguiente != rx_cola) {
+              rx_buffer[rx_cabeza] = rx_dato;
+              rx_cabeza = siguiente;
+          }
+      }
+#ifdef SERIAL_SW_VALIDAR_STOP
+      else if(rx_dato) {
+          serial_sw_errores_trama++;
+      } else {
+          serial_sw_breaks++;
+      }
+#endif
+  }
+  rx_bits--;
+}
+
+#ifdef SERIAL_SW_FULL_DUPLEX
+/**
+  * @brief Rutina a llamar desde la interrupción de un temporizador con periodo CYCLES_FD_TICK_PERIOD (SERIAL_SW_OVERSAMPLING
+  * veces por bit). Transmite un bit cada SERIAL_SW_OVERSAMPLING interrupciones y sobremuestrea SW_RX: el START se detecta con
+  * una incertidumbre de una interrupción y cada bit se muestrea lo más cerca posible de su mitad.
   * @param (void)
-  * @return (uint8_t) Dato de 8 bits que ha sido recibido mediante USART por software
+  * @return (void)
+*/
+void serial_sw_fd_isr(void) {
+  bool nivel;
+  //Transmisión
+  if(!fd_tx_ticks) {
+      fd_tx_ticks = SERIAL_SW_OVERSAMPLING;
+      serial_sw_tx_isr();
+  }
+  fd_tx_ticks--;
+  //Recepción
+  if(!rx_bits) {
+      if(SW_RX) {
+          fd_rx_inactivo = true;
+      } else if(fd_rx_inactivo) {       //Flanco de START
+          fd_rx_inactivo = false;
+          rx_bits = 10;
+          fd_rx_ticks = SERIAL_SW_OVERSAMPLING/2;
+      }
+  } else if(!--fd_rx_ticks) {
+      fd_rx_ticks = SERIAL_SW_OVERSAMPLING;
+      nivel = SW_RX;
+      serial_sw_rx_muestra(nivel);
+      //Un STOP en alto ya cuenta como línea inactiva: con tramas seguidas el START siguiente puede llegar antes de otra interrupción
+      fd_rx_inactivo = nivel;
+  }
+}
+#else
+/**
+  * @brief Rutina a llamar desde la interrupción por flanco en SW_RX. Si la línea está en bajo y no hay trama en curso, arranca
+  * el temporizador para muestrear el bit de START a la mitad y deshabilita la interrupción por flanco hasta el bit de STOP.
+  * @param (void)
+  * @return (void)
+*/
+void serial_sw_rx_edge_isr(void) {
+  if(rx_bits || SW_RX)
+      return;
+  SERIAL_SW_RX_FLANCO_DESHABILITAR();
+  SERIAL_SW_RX_TIMER_INICIAR(CYCLES_BIT_PERIOD/2);
+  rx_bits = 10;
+}
+
+/**
+  * @brief Rutina a llamar desde la interrupción del temporizador: toma una muestra a la mitad de cada bit
+  * @param (void)
+  * @return (void)
+*/
+void serial_sw_rx_timer_isr(void) {
+  SERIAL_SW_RX_TIMER_RECARGAR(CYCLES_BIT_PERIOD);
+  serial_sw_rx_muestra(SW_RX);
+  if(!rx_bits) {
+      SERIAL_SW_RX_TIMER_DETENER();
+      SERIAL_SW_RX_FLANCO_HABILITAR();
+  }
+}
+#endif
+
+/**
+  * @brief Función que obtiene la cantidad de bytes recibidos pendientes de leer
+  * @param (void)
+  * @return (uint16_t) Bytes disponibles en el buffer de recepción
+*/
+uint16_t serial_sw_available(void) {
+  return (uint8_t)(rx_cabeza - rx_cola) & SERIAL_SW_RX_MASCARA;
+}
+
+/**
+  * @brief Función que toma un byte del buffer de recepción sin esperar
+  * @param (void)
+  * @return (uint8_t) Byte recibido, o 0 si el buffer está vacío (ver serial_sw_available())
 */
 uint8_t serial_sw_readByte() {
+  uint8_t dato = 0;
+  if(rx_cola != rx_cabeza) {
+      dato = rx_buffer[rx_cola];
+      rx_cola = (rx_cola + 1) & SERIAL_SW_RX_MASCARA;
+  }
+  return dato;
+}
+#else
+/**
+  * @brief Función interna que recibe una trama a partir del flanco de bajada del bit de START, ya detectado
+  * @param (void)
+  * @return (uint8_t) Dato de 8 bits recibido
+*/
+static uint8_t serial_sw_recibirTrama(void) {
+#if defined(SERIAL_SW_RX_MAYORIA) || !defined(SERIAL_SW_BIT_FRACCIONAL)
   uint8_t bit_count;
+#endif
   uint8_t dato=0;
-  //Espera condición START
-  while(SW_RX);
+#ifdef SERIAL_SW_RX_MAYORIA
+  uint8_t muestras;
+  _delay(CYCLES_DELAY_RX_MAYORIA_INICIO);
+  for(bit_count=8; bit_count; bit_count--) {
+      muestras = SW_RX;
+      _delay(CYCLES_DELAY_RX_MUESTRA);
+      muestras += SW_RX;
+      _delay(CYCLES_DELAY_RX_MUESTRA);
+      muestras += SW_RX;
+      dato >>= 1;
+      if(muestras & 0x02)               //Al menos 2 de 3 muestras en alto
+          dato |= 0x80;
+      _delay(CYCLES_DELAY_RX_MAYORIA_BIT);
+  }
+  return dato;
+#elif defined(SERIAL_SW_BIT_FRACCIONAL)
+  _delay(CYCLES_DELAY_RX_FRAC_INICIO);
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(1));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(2));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(3));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(4));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(5));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(6));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(7));
+  dato >>= 1; if(SW_RX) dato |= 0x80; _delay(CYCLES_DELAY_RX_FRAC(8));   //Hasta la mitad del STOP
+  return dato;
+#elif defined(SERIAL_SW_BAUD_VARIABLE)
+  const uint16_t *retardo = serial_sw_tiempos->rx;
+  serial_sw_retardo(*retardo++);
+  for(bit_count=8; bit_count; bit_count--) {
+      dato >>= 1;
+      if(SW_RX)
+          dato |= 0x80;
+      serial_sw_retardo(*retardo++);      //El último retardo llega a la mitad del STOP
+  }
+  return dato;
+#else
   _delay(CYCLES_DELAY_RX_BIT);
   _delay(CYCLES_DELAY_RX_HALFBIT);
   for(bit_count=0; bit_count!=8;bit_count++) {
@@ -63,6 +532,162 @@ uint8_t serial_sw_readByte() {
       _delay(CYCLES_DELAY_RX_BIT);
   }
   return dato;
+#endif
+}
+
+#ifdef SERIAL_SW_VALIDAR_STOP
+/**
+  * @brief Función interna que verifica el bit de STOP a la mitad de su periodo (al regresar de serial_sw_recibirTrama()). Si está
+  * en bajo cuenta el error y espera a que la línea regrese al estado inactivo.
+  * @param dato: (uint8_t) Dato recibido en la trama
+  * @param espera: (uint32_t *) Iteraciones máximas de espera del estado inactivo, se actualiza (NULL para esperar sin límite)
+  * @return (serial_sw_estado_t) SERIAL_SW_OK, SERIAL_SW_ERROR_TRAMA o SERIAL_SW_BREAK
+*/
+static serial_sw_estado_t serial_sw_validarStop(uint8_t dato, uint32_t *espera) {
+  serial_sw_estado_t estado;
+  if(SW_RX)
+      return SERIAL_SW_OK;
+  if(dato) {
+      serial_sw_errores_trama++;
+      estado = SERIAL_SW_ERROR_TRAMA;
+  } else {
+      serial_sw_breaks++;
+      estado = SERIAL_SW_BREAK;
+  }
+  //Resincronización: el siguiente START debe partir del estado inactivo
+  while(!SW_RX) {
+      if(espera) {
+          if(!*espera)
+              break;
+          (*espera)--;
+      }
+  }
+  return estado;
+}
+#endif
+
+/**
+  * @brief Función para recepción de un byte vía USART por software.                       
+  * Importante desactivar interrupciones durante su ejecución para evitar errores de sincronización.
+  * @param (void)
+  * @return (uint8_t) Dato de 8 bits que ha sido recibido mediante USART por software
+*/
+uint8_t serial_sw_readByte() {
+#ifdef SERIAL_SW_VALIDAR_STOP
+  uint8_t dato;
+  do {
+      //Espera condición START
+      while(SW_RX);
+      dato = serial_sw_recibirTrama();
+  } while(serial_sw_validarStop(dato,0) != SERIAL_SW_OK);
+  return dato;
+#else
+  //Espera condición START
+  while(SW_RX);
+  return serial_sw_recibirTrama();
+#endif
+}
+#endif
+
+/**
+  * @brief Función interna que espera el inicio de una trama (o un byte en el buffer, con SERIAL_SW_RX_ISR) descontando del presupuesto
+  * de espera una unidad por iteración
+  * @param espera: (uint32_t *) Iteraciones de espera restantes, se actualiza
+  * @return (bool) true si llegó una trama, false si se agotó el presupuesto
+*/
+static bool serial_sw_esperarTrama(uint32_t *espera) {
+  uint32_t n = *espera;
+#ifdef SERIAL_SW_RX_ISR
+  while(rx_cola == rx_cabeza) {
+#else
+  while(SW_RX) {
+#endif
+      if(!n) {
+          *espera = 0;
+          return false;
+      }
+      n--;
+#ifdef SERIAL_SW_RX_ISR
+      NOP();
+#endif
+  }
+  *espera = n;
+  return true;
+}
+
+/**
+  * @brief Función para leer una cantidad de bytes con tiempo límite para toda la operación
+  * @param datos: (void*) Destino de los bytes recibidos
+  * @param len: (uint16_t) Cantidad de bytes a recibir
+  * @param recibidos: (uint16_t *) Cantidad de bytes recibidos antes de terminar (puede ser NULL)
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK si se recibieron todos los bytes, SERIAL_SW_TIMEOUT en caso contrario
+*/
+serial_sw_estado_t serial_sw_readTimeout(void* datos, uint16_t len, uint16_t *recibidos, uint32_t ciclos) {
+  uint8_t* _datos = (uint8_t*)datos;
+  uint32_t espera = ciclos / SERIAL_SW_CICLOS_ESPERA;
+  serial_sw_estado_t estado = SERIAL_SW_OK;
+  uint16_t n;
+#if !defined(SERIAL_SW_RX_ISR) && defined(SERIAL_SW_VALIDAR_STOP)
+  uint8_t dato;
+#endif
+  for(n=0;n!=len;) {
+      if(!serial_sw_esperarTrama(&espera)) {
+          estado = SERIAL_SW_TIMEOUT;
+          break;
+      }
+#ifdef SERIAL_SW_RX_ISR
+      _datos[n++] = serial_sw_readByte();
+#elif defined(SERIAL_SW_VALIDAR_STOP)
+      dato = serial_sw_recibirTrama();
+      espera = (espera > SERIAL_SW_ESPERA_TRAMA)? espera - SERIAL_SW_ESPERA_TRAMA : 0;
+      if(serial_sw_validarStop(dato,&espera) == SERIAL_SW_OK)
+          _datos[n++] = dato;
+#else
+      _datos[n++] = serial_sw_recibirTrama();
+      //La recepción de la trama también consume el tiempo límite
+      espera = (espera > SERIAL_SW_ESPERA_TRAMA)? espera - SERIAL_SW_ESPERA_TRAMA : 0;
+#endif
+  }
+  if(recibidos)
+      *recibidos = n;
+  return estado;
+}
+
+/**
+  * @brief Función para recepción de un byte con tiempo límite
+  * @param dato: (uint8_t *) Byte recibido
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK o SERIAL_SW_TIMEOUT
+*/
+serial_sw_estado_t serial_sw_readByteTimeout(uint8_t *dato, uint32_t ciclos) {
+  return serial_sw_readTimeout(dato,1,0,ciclos);
+}
+
+/**
+  * @brief Función para recepción de un byte sin esperar: si la línea está inactiva (o el buffer vacío, con SERIAL_SW_RX_ISR) regresa
+  * de inmediato. Sin SERIAL_SW_RX_ISR, un nivel bajo en SW_RX se toma como bit de START y la trama se recibe completa; con
+  * SERIAL_SW_VALIDAR_STOP, una trama inválida se informa y se espera a lo más una trama a que la línea quede inactiva.
+  * @param dato: (uint8_t *) Byte recibido
+  * @return (serial_sw_estado_t) SERIAL_SW_OK, SERIAL_SW_VACIO, SERIAL_SW_ERROR_TRAMA o SERIAL_SW_BREAK
+*/
+serial_sw_estado_t serial_sw_pollByte(uint8_t *dato) {
+#ifdef SERIAL_SW_RX_ISR
+  if(rx_cola == rx_cabeza)
+      return SERIAL_SW_VACIO;
+  *dato = serial_sw_readByte();
+#else
+#ifdef SERIAL_SW_VALIDAR_STOP
+  uint32_t espera = SERIAL_SW_ESPERA_TRAMA;
+#endif
+  if(SW_RX)
+      return SERIAL_SW_VACIO;
+  *dato = serial_sw_recibirTrama();
+#ifdef SERIAL_SW_VALIDAR_STOP
+  return serial_sw_validarStop(*dato,&espera);
+#endif
+#endif
+  return SERIAL_SW_OK;
 }
 
 /**
@@ -91,15 +716,23 @@ void serial_sw_writeLine(const char *cadena)
 
 /**
   * @brief Función para lectura de una cantidad de elementos, para ponerlos en un buffer (arreglo) .
+  * Con SERIAL_SW_RX_ISR sólo se copian los bytes ya recibidos, sin esperar.
   * @param buff: (const char *) Apuntador al arreglo en el cual se desean copiar los datos.
   * @param len: (uint16_t) Cantidad de elementos a copiar de un buffer a otro
-  * @return (void)
+  * @return (uint16_t) Cantidad de elementos copiados
 */
-void serial_sw_gets(uint8_t *buffer, uint16_t len) {
+uint16_t serial_sw_gets(uint8_t *buffer, uint16_t len) {
+    uint16_t leidos = 0;
     for(;len;len--) {
+#ifdef SERIAL_SW_RX_ISR
+        if(!serial_sw_available())
+            break;
+#endif
         *buffer = serial_sw_readByte();    //Obtención de caracter del buffer serial, se almacena en el arreglo de caracteres
         buffer++; //se incremento de apuntador al arreglo
+        leidos++;
     }
+    return leidos;
 }
 
 /**
@@ -221,14 +854,238 @@ float serial_sw_readFloat() {
 
 /**
   * @brief Función para leer un dato de cualquier tipo por medio de USART por software
+  * Con SERIAL_SW_RX_ISR sólo se copian los bytes ya recibidos, sin esperar.
   * @param datos: (void*) Dato de cualquier tipo a recibir mediante USART por software
   * @param len: (uint16_t) Cantidad de bytes a recibir. Usado generalmente con la función sizeof() y un tipo de datos no estándar,
   * como una estructura de datos.
+  * @return (uint16_t) Cantidad de bytes recibidos
+*/
+uint16_t serial_sw_read(void* datos, uint16_t len) {
+	return serial_sw_gets((uint8_t*)datos,len);
+}
+
+/**
+  * @brief Función para lectura de una cantidad de elementos con tiempo límite (ver serial_sw_readTimeout())
+  * @param buffer: (uint8_t *) Apuntador al arreglo en el cual se desean copiar los datos.
+  * @param len: (uint16_t) Cantidad de elementos a recibir
+  * @param recibidos: (uint16_t *) Cantidad de elementos recibidos antes de terminar (puede ser NULL)
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK o SERIAL_SW_TIMEOUT
+*/
+serial_sw_estado_t serial_sw_getsTimeout(uint8_t *buffer, uint16_t len, uint16_t *recibidos, uint32_t ciclos) {
+    return serial_sw_readTimeout(buffer,len,recibidos,ciclos);
+}
+
+/**
+  * @brief Función para leer un dato entero de 2 bytes con tiempo límite. Si se agota, el dato contiene sólo los bytes recibidos.
+  * @param dato: (uint16_t *) Dato de 16 bits recibido
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK o SERIAL_SW_TIMEOUT
+*/
+serial_sw_estado_t serial_sw_readInt16Timeout(uint16_t *dato, uint32_t ciclos) {
+    return serial_sw_readTimeout(dato,sizeof(uint16_t),0,ciclos);
+}
+
+/**
+  * @brief Función para leer un dato entero de 3 bytes con tiempo límite. Si se agota, el dato contiene sólo los bytes recibidos.
+  * @param dato: (uint24_t *) Dato de 24 bits recibido
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK o SERIAL_SW_TIMEOUT
+*/
+serial_sw_estado_t serial_sw_readInt24Timeout(uint24_t *dato, uint32_t ciclos) {
+    return serial_sw_readTimeout(dato,sizeof(uint24_t),0,ciclos);
+}
+
+/**
+  * @brief Función para leer un dato entero de 4 bytes con tiempo límite. Si se agota, el dato contiene sólo los bytes recibidos.
+  * @param dato: (uint32_t *) Dato de 32 bits recibido
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK o SERIAL_SW_TIMEOUT
+*/
+serial_sw_estado_t serial_sw_readInt32Timeout(uint32_t *dato, uint32_t ciclos) {
+    return serial_sw_readTimeout(dato,sizeof(uint32_t),0,ciclos);
+}
+
+/**
+  * @brief Función para leer un dato flotante de 4(3) bytes con tiempo límite. Si se agota, el dato contiene sólo los bytes recibidos.
+  * @param dato: (float *) Dato flotante recibido
+  * @param ciclos: (uint32_t) Tiempo límite en ciclos de instrucción
+  * @return (serial_sw_estado_t) SERIAL_SW_OK o SERIAL_SW_TIMEOUT
+*/
+serial_sw_estado_t serial_sw_readFloatTimeout(float *dato, uint32_t ciclos) {
+    return serial_sw_readTimeout(dato,sizeof(float),0,ciclos);
+}
+
+#ifdef SERIAL_SW_VALIDAR_STOP
+/**
+  * @brief Función que obtiene la cantidad de tramas descartadas por bit de STOP en bajo (sin contar breaks)
+  * @param (void)
+  * @return (uint16_t) Errores de trama desde el inicio o desde serial_sw_clearErrores()
+*/
+uint16_t serial_sw_getErroresTrama(void) {
+  return serial_sw_errores_trama;
+}
+
+/**
+  * @brief Función que obtiene la cantidad de condiciones de break detectadas
+  * @param (void)
+  * @return (uint16_t) Breaks desde el inicio o desde serial_sw_clearErrores()
+*/
+uint16_t serial_sw_getBreaks(void) {
+  return serial_sw_breaks;
+}
+
+/**
+  * @brief Función que reinicia los contadores de errores de trama y breaks
+  * @param (void)
   * @return (void)
 */
-void serial_sw_read(void* datos, uint16_t len) {
-	uint8_t* _datos = (uint8_t*)datos;           //Apuntador a variable
-	while(len--) {
-		*(_datos++) = serial_sw_readByte();      //Recepción de datos
-	}
-}
\ No newline at end of file
+void serial_sw_clearErrores(void) {
+  serial_sw_errores_trama = 0;
+  serial_sw_breaks = 0;
+}
+#endif
+
+#ifdef SERIAL_SW_BAUD_VARIABLE
+/**
+  * @brief Función de detección automática de velocidad. Espera el bit de START de un carácter de sincronía conocido y mide,
+  * con un lazo de SERIAL_SW_CICLOS_MEDICION ciclos por iteración, el tiempo hasta su último flanco; a partir de él calcula los
+  * retardos de transmisión y recepción. El carácter de sincronía no se entrega como dato.
+  * @param sincronia: (uint8_t) Carácter de sincronía esperado (0x55 o 0x0D ofrecen flancos en toda la trama)
+  * @return (bool) true si se midió la velocidad, false si la medición excedió el contador (la velocidad no cambia)
+*/
+bool serial_sw_autobaud(uint8_t sincronia) {
+  uint8_t k, bit, nivel = 0, flancos = 0, ultimo = 0;
+  uint16_t n = 0;
+  //Flancos esperados después del START y posición (en bits) del último
+  for(k=1;k!=10;k++) {
+      bit = (k == 9)? 1 : (sincronia >> (k-1)) & 0x01;
+      if(bit != nivel) {
+          flancos++;
+          ultimo = k;
+          nivel = bit;
+      }
+  }
+  //Espera condición START
+  while(SW_RX);
+  nivel = 0;
+  do {
+      do {                              //Se cuenta también la iteración que detecta el flanco
+          if(!++n)
+              return false;
+      } while(SW_RX == nivel);
+      nivel ^= 1;
+  } while(--flancos);
+  serial_sw_calcularTiempos((uint32_t)n*SERIAL_SW_CICLOS_MEDICION,ultimo);
+  serial_sw_baud = ((_XTAL_FREQ/4)*ultimo + (uint32_t)n*SERIAL_SW_CICLOS_MEDICION/2) / ((uint32_t)n*SERIAL_SW_CICLOS_MEDICION);
+  return true;
+}
+
+/**
+  * @brief Función que obtiene la velocidad de comunicación actual
+  * @param (void)
+  * @return (uint32_t) Velocidad en bits por segundo
+*/
+uint32_t serial_sw_getBaud(void) {
+  return serial_sw_baud;
+}
+
+/**
+  * @brief Función que cambia la velocidad de comunicación a una de la tabla precalculada para _XTAL_FREQ (1200 a 115200,
+  * sólo las que alcanzan con la frecuencia del oscilador)
+  * @param baud: (uint32_t) Velocidad en bits por segundo
+  * @return (bool) true si la velocidad está en la tabla, false en caso contrario (la velocidad no cambia)
+*/
+bool serial_sw_setBaud(uint32_t baud) {
+  for(uint8_t i=0;i!=sizeof(serial_sw_velocidades)/sizeof(serial_sw_velocidades[0]);i++) {
+      if(serial_sw_velocidades[i].baud == baud) {
+          serial_sw_usarTiempos(&serial_sw_velocidades[i].tiempos);
+          serial_sw_baud = baud;
+          return true;
+      }
+  }
+  return false;
+}
+#endif
+
+#ifdef SERIAL_SW_TX_LANES
+static uint8_t serial_sw_lanes_mascara;    //Canales TX en uso
+
+/**
+  * @brief Función para configurar como salidas en estado inactivo (alto) los canales TX indicados
+  * @param mascara: (uint8_t) Canales a utilizar (bit n = canal n del puerto SW_TX_LANES_LAT)
+  * @return (void)
+*/
+void serial_sw_lanes_init(uint8_t mascara) {
+    serial_sw_lanes_mascara = mascara;
+    SW_TX_LANES_LAT |= mascara;
+    SW_TX_LANES_TRIS &= ~mascara;
+}
+
+/**
+  * @brief Función interna que transmite una trama en los canales activos. Los bytes se transponen en planos de bits (incluyendo
+  * START y STOP) antes de transmitir, de modo que cada periodo de bit es una sola escritura al puerto y un solo retardo.
+  * @param datos: (const uint8_t *) 8 bytes, datos[n] corresponde al canal n
+  * @param activos: (uint8_t) Canales que transmiten; el resto de los canales de la máscara permanece en alto
+  * @return (void)
+*/
+static void serial_sw_lanes_trama(const uint8_t *datos, uint8_t activos) {
+    uint8_t planos[10], copia[8], i, canal, plano, inactivos;
+    inactivos = (SW_TX_LANES_LAT & ~serial_sw_lanes_mascara) | (serial_sw_lanes_mascara & ~activos);
+    for(canal=0;canal!=8;canal++)
+        copia[canal] = datos[canal];
+    planos[0] = inactivos; //START
+    for(i=1;i!=9;i++) {    //Bits de datos, del menos al más significativo
+        plano = 0;
+        for(canal=8;canal;) {
+            canal--;
+            plano <<= 1;
+            if(copia[canal] & 0x01)
+                plano |= 0x01;
+            copia[canal] >>= 1;
+        }
+        planos[i] = (plano & activos) | inactivos;
+    }
+    planos[9] = inactivos | activos; //STOP
+    for(i=0;i!=10;i++) {
+        SW_TX_LANES_LAT = planos[i];
+        _delay(CYCLES_DELAY_TX_LANES_BIT);
+    }
+}
+
+/**
+  * @brief Función que transmite un byte distinto en cada canal de manera simultánea
+  * @param datos: (const uint8_t *) 8 bytes, datos[n] se transmite por el canal n (se ignoran los canales fuera de la máscara)
+  * @return (void)
+*/
+void serial_sw_lanes_writeByte(const uint8_t *datos) {
+    serial_sw_lanes_trama(datos,serial_sw_lanes_mascara);
+}
+
+/**
+  * @brief Función de escritura simultánea de una cadena de caracteres por canal. Los canales cuya cadena ya terminó permanecen
+  * en estado inactivo mientras el resto continúa.
+  * @param cadenas: (const char **) 8 apuntadores, cadenas[n] se transmite por el canal n (NULL si el canal no transmite)
+  * @return (void)
+*/
+void serial_sw_lanes_puts(const char **cadenas) {
+    const char *p[8];
+    uint8_t datos[8], canal, activos;
+    for(canal=0;canal!=8;canal++)
+        p[canal] = cadenas[canal];
+    for(;;) {
+        activos = 0;
+        for(canal=0;canal!=8;canal++) {
+            datos[canal] = 0;
+            if(p[canal] && *p[canal]) {
+                datos[canal] = *p[canal]++;
+                activos |= 1<<canal;
+            }
+        }
+        activos &= serial_sw_lanes_mascara;
+        if(!activos)
+            break;
+        serial_sw_lanes_trama(datos,activos);
+    }
+}
+#endif
@@ -4,10 +4,79 @@
  * @author Ing. José Roberto Parra Trewartha
 */
 
+#ifndef SW_BAUDRATE
 #define SW_BAUDRATE	9600UL														//Definición de velocidad de comunicación en bits por segundo. Cambiar según necesidades del proyecto.	
+#endif
 #define CYCLES_DELAY_RX_BIT (((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)-14)		//Retardo por bit en recepción
 #define CYCLES_DELAY_RX_HALFBIT (((((2*_XTAL_FREQ)/(8*SW_BAUDRATE))+1)/2)-9)	//Retardo por medio bit en recepción
 #define CYCLES_DELAY_TX_BIT (((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)-12)		//Retardo por bit en transmisión
+#define CYCLES_BIT_PERIOD ((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)				//Periodo de bit en ciclos de instrucción (para temporizadores)
+
+/**
+ * Recepción por mayoría: cada bit se muestrea tres veces alrededor de su mitad (separadas CYCLES_RX_SEPARACION ciclos) y se decide
+ * por mayoría, lo que tolera ruido de corta duración a velocidades altas (57600, 115200). Las correcciones de cada retardo incluyen
+ * el costo estimado de las muestras y del lazo. Aplica a la recepción bloqueante (readByte, lecturas con tiempo límite y pollByte).
+*/
+//#define SERIAL_SW_RX_MAYORIA
+
+#define CYCLES_RX_SEPARACION (((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)/8)				//Separación entre muestras (1/8 de bit)
+#define CYCLES_DELAY_RX_MUESTRA (CYCLES_RX_SEPARACION-4)								//Retardo entre muestras de un mismo bit
+#define CYCLES_DELAY_RX_MAYORIA_INICIO ((((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)*3/2)-CYCLES_RX_SEPARACION-9)	//Del START a la primera muestra
+#define CYCLES_DELAY_RX_MAYORIA_BIT (((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)-(2*CYCLES_RX_SEPARACION)-11)	//Retardo restante de cada bit
+
+/**
+ * Temporización fraccional: en lugar de repetir un periodo de bit entero, cada bit de la trama tiene su propio retardo, calculado
+ * como la diferencia entre los bordes (o mitades) de bit ideales redondeados al ciclo más cercano. El residuo fraccional se reparte
+ * entre los bits (como en el algoritmo de Bresenham) y el error acumulado en la trama no excede medio ciclo. Los lazos de bits se
+ * desenrollan. Aplica a la transmisión bloqueante y a la recepción bloqueante sin SERIAL_SW_RX_MAYORIA.
+*/
+//#define SERIAL_SW_BIT_FRACCIONAL
+
+#define CYCLES_BORDE_BIT(k) (((((2*(k))*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)				//Inicio ideal del bit k de la trama (0 = START)
+#define CYCLES_MITAD_BIT(k) (((((4*(k)+2)*_XTAL_FREQ)/(8*SW_BAUDRATE))+1)/2)			//Mitad ideal del bit k de la trama
+#define CYCLES_DELAY_TX_FRAC(k) (CYCLES_BORDE_BIT((k)+1)-CYCLES_BORDE_BIT(k)-6)		//Retardo del bit k en transmisión
+#define CYCLES_DELAY_RX_FRAC(k) (CYCLES_MITAD_BIT((k)+1)-CYCLES_MITAD_BIT(k)-4)		//Retardo entre las muestras de los bits k y k+1
+#define CYCLES_DELAY_RX_FRAC_INICIO (CYCLES_MITAD_BIT(1)-9)							//Del flanco de START a la muestra del bit 1
+
+/**
+ * Error de temporización en milésimas de ciclo, publicado en tiempo de compilación. SERIAL_SW_ERROR_TRAMA_MCICLOS es el peor caso
+ * en los bordes de bit de una trama de 10 bits con el modo seleccionado (entero: crece con cada bit; fraccional: no excede 500).
+*/
+#define SERIAL_SW_DIF(a,b) (((a)>(b))?((a)-(b)):((b)-(a)))
+#define SERIAL_SW_MAX(a,b) (((a)>(b))?(a):(b))
+#define SERIAL_SW_ERROR_BORDE_MCICLOS(inicio,k) (SERIAL_SW_DIF((inicio)*4*SW_BAUDRATE,(k)*_XTAL_FREQ)*1000/(4*SW_BAUDRATE))
+#define SERIAL_SW_ERROR_ENTERO_MCICLOS SERIAL_SW_ERROR_BORDE_MCICLOS(10*CYCLES_BIT_PERIOD,10)
+#define SERIAL_SW_ERROR_FRAC_K(k) SERIAL_SW_ERROR_BORDE_MCICLOS(CYCLES_BORDE_BIT(k),k)
+#define SERIAL_SW_ERROR_FRAC_MCICLOS SERIAL_SW_MAX(SERIAL_SW_MAX(SERIAL_SW_MAX(SERIAL_SW_ERROR_FRAC_K(1),SERIAL_SW_ERROR_FRAC_K(2)), \
+    SERIAL_SW_MAX(SERIAL_SW_ERROR_FRAC_K(3),SERIAL_SW_ERROR_FRAC_K(4))),SERIAL_SW_MAX(SERIAL_SW_MAX(SERIAL_SW_ERROR_FRAC_K(5), \
+    SERIAL_SW_ERROR_FRAC_K(6)),SERIAL_SW_MAX(SERIAL_SW_MAX(SERIAL_SW_ERROR_FRAC_K(7),SERIAL_SW_ERROR_FRAC_K(8)), \
+    SERIAL_SW_MAX(SERIAL_SW_ERROR_FRAC_K(9),SERIAL_SW_ERROR_FRAC_K(10)))))
+#ifdef SERIAL_SW_BIT_FRACCIONAL
+#define SERIAL_SW_ERROR_TRAMA_MCICLOS SERIAL_SW_ERROR_FRAC_MCICLOS
+#else
+#define SERIAL_SW_ERROR_TRAMA_MCICLOS SERIAL_SW_ERROR_ENTERO_MCICLOS
+#endif
+
+/**
+ * Presupuesto de error: serial_sw.c no compila si el periodo de bit no alcanza para las correcciones de los retardos de la
+ * recepción/transmisión bloqueante (SERIAL_SW_PERIODO_MINIMO ciclos), o si el error de temporización de la trama excede
+ * SERIAL_SW_TOLERANCIA. HOST_SIM/serial_sw_tabla.c genera la tabla de combinaciones de cristal y velocidad.
+*/
+#ifndef SERIAL_SW_TOLERANCIA
+#define SERIAL_SW_TOLERANCIA        200     //Error máximo permitido, en centésimas de porcentaje (2.00 %)
+#endif
+#define SERIAL_SW_PERIODO_MINIMO_ENTERO     20
+#define SERIAL_SW_PERIODO_MINIMO_FRAC       8
+#define SERIAL_SW_PERIODO_MINIMO_MAYORIA    40
+#if defined(SERIAL_SW_RX_MAYORIA)
+#define SERIAL_SW_PERIODO_MINIMO SERIAL_SW_PERIODO_MINIMO_MAYORIA
+#elif defined(SERIAL_SW_BIT_FRACCIONAL)
+#define SERIAL_SW_PERIODO_MINIMO SERIAL_SW_PERIODO_MINIMO_FRAC
+#else
+#define SERIAL_SW_PERIODO_MINIMO SERIAL_SW_PERIODO_MINIMO_ENTERO
+#endif
+#define SERIAL_SW_BAUD_REAL ((((2*_XTAL_FREQ)/(4*CYCLES_BIT_PERIOD))+1)/2)	//Velocidad obtenida con el periodo de bit entero
+#define SERIAL_SW_ERROR_CENTESIMAS (SERIAL_SW_ERROR_TRAMA_MCICLOS/CYCLES_BIT_PERIOD)	//Error de temporización de la trama, centésimas de %
 
 /**
  * Definición de pines RX y TX para comunicación serial por software
@@ -18,6 +87,134 @@
 #define SW_TX       LATBbits.LATB6
 #define SW_TX_TRIS	TRISBbits.TRISB6
 
+/**
+ * Transmisión multicanal (bit-sliced): hasta 8 líneas TX en un mismo puerto, que transmiten bytes distintos de manera simultánea
+ * con el mismo formato 8N1 y un solo retardo por periodo de bit. El bit n del puerto corresponde al canal n.
+*/
+//#define SERIAL_SW_TX_LANES
+
+#ifndef SW_TX_LANES_LAT
+#define SW_TX_LANES_LAT     LATD
+#define SW_TX_LANES_TRIS    TRISD
+#endif
+#define CYCLES_DELAY_TX_LANES_BIT (((((2*_XTAL_FREQ)/(4*SW_BAUDRATE))+1)/2)-10)	//Retardo por bit en transmisión multicanal
+
+/**
+ * Transmisión en segundo plano: serial_sw_writeByte() (y con ella puts, writeLine, write, etc.) sólo coloca el byte en un buffer
+ * circular y regresa de inmediato; si el buffer está lleno espera a que se libere un lugar. La transmisión la realiza
+ * serial_sw_tx_isr(), que debe llamarse desde la interrupción de un temporizador con periodo de un bit (CYCLES_BIT_PERIOD ciclos
+ * de instrucción, p. ej. TMR2 con PR2 = CYCLES_BIT_PERIOD-1 y el pre/postescalador necesario). Cada llamada emite un bit.
+*/
+//#define SERIAL_SW_TX_ISR
+
+#ifndef SERIAL_SW_TX_BUFFER_SIZE
+#define SERIAL_SW_TX_BUFFER_SIZE    32      //Tamaño del buffer de transmisión, potencia de 2 (máximo 256)
+#endif
+
+/**
+ * Recepción en segundo plano: el flanco de bajada del bit de START en SW_RX dispara serial_sw_rx_edge_isr() (interrupción por
+ * cambio de estado o INTx), que arranca un temporizador para muestrear a la mitad de cada bit mediante serial_sw_rx_timer_isr().
+ * Los bytes recibidos se guardan en un buffer circular, y serial_sw_readByte(), serial_sw_gets() y serial_sw_read() sólo toman
+ * lo disponible sin esperar; readInt16/24/32 y readFloat deben llamarse una vez que serial_sw_available() indique los bytes
+ * suficientes. Las banderas de interrupción las limpia la rutina de interrupción del usuario.
+*/
+//#define SERIAL_SW_RX_ISR
+
+#ifndef SERIAL_SW_RX_BUFFER_SIZE
+#define SERIAL_SW_RX_BUFFER_SIZE    32      //Tamaño del buffer de recepción, potencia de 2 (máximo 256)
+#endif
+
+/**
+ * Control del temporizador y de la interrupción por flanco de la recepción en segundo plano. Por defecto se usan TMR1 (preescalador
+ * 1:1, periodo de bit de hasta 65535 ciclos) y la interrupción por cambio de estado de PORTB; pueden redefinirse antes de incluir este archivo.
+*/
+#ifndef SERIAL_SW_RX_TIMER_INICIAR
+#define SERIAL_SW_RX_TIMER_INICIAR(ciclos)  {T1CONbits.TMR1ON=0;TMR1=(uint16_t)(65536UL-(ciclos));PIR1bits.TMR1IF=0;PIE1bits.TMR1IE=1;T1CONbits.TMR1ON=1;}
+#define SERIAL_SW_RX_TIMER_RECARGAR(ciclos) {TMR1+=(uint16_t)(65536UL-(ciclos));}	//Recarga sin acumular la latencia de la interrupción
+#define SERIAL_SW_RX_TIMER_DETENER()        {T1CONbits.TMR1ON=0;PIE1bits.TMR1IE=0;}
+#define SERIAL_SW_RX_FLANCO_HABILITAR()     {INTCONbits.RBIE=1;}
+#define SERIAL_SW_RX_FLANCO_DESHABILITAR()  {INTCONbits.RBIE=0;}
+#endif
+
+/**
+ * Full duplex: transmisión y recepción simultáneas desde una sola interrupción de temporizador, serial_sw_fd_isr(), con periodo de
+ * 1/SERIAL_SW_OVERSAMPLING de bit (CYCLES_FD_TICK_PERIOD ciclos de instrucción). Utiliza los buffers y funciones de SERIAL_SW_TX_ISR
+ * y SERIAL_SW_RX_ISR, sin interrupción por flanco ni las macros SERIAL_SW_RX_TIMER_x.
+*/
+//#define SERIAL_SW_FULL_DUPLEX
+
+#ifndef SERIAL_SW_OVERSAMPLING
+#define SERIAL_SW_OVERSAMPLING      3       //Interrupciones por bit (3 o 4)
+#endif
+#define CYCLES_FD_TICK_PERIOD ((((2*_XTAL_FREQ)/(4*SW_BAUDRATE*SERIAL_SW_OVERSAMPLING))+1)/2)	//Periodo de la interrupción full duplex
+
+#ifdef SERIAL_SW_FULL_DUPLEX
+#define SERIAL_SW_TX_ISR
+#define SERIAL_SW_RX_ISR
+#endif
+
+/**
+ * Lecturas con tiempo límite. El tiempo se cuenta en ciclos de instrucción y se convierte una sola vez a iteraciones del lazo que
+ * espera el bit de START, sin costo adicional por bit; cada trama recibida descuenta su duración. Ajustar SERIAL_SW_CICLOS_ESPERA
+ * al costo real del lazo si se requiere precisión en el tiempo límite.
+*/
+#ifndef SERIAL_SW_CICLOS_ESPERA
+#define SERIAL_SW_CICLOS_ESPERA     10      //Ciclos de instrucción por iteración del lazo de espera con tiempo límite
+#endif
+#define SERIAL_SW_ESPERA_TRAMA      ((CYCLES_BIT_PERIOD*19/2)/SERIAL_SW_CICLOS_ESPERA)	//Duración de la recepción de una trama, en iteraciones
+
+/**
+ * Velocidad variable en tiempo de ejecución: los retardos por bit de la transmisión y recepción bloqueantes se toman de una tabla
+ * de iteraciones de un lazo de retardo (SERIAL_SW_CICLOS_ITERACION ciclos cada una) en lugar de constantes de compilación. El residuo
+ * de cada bit se reparte a lo largo de la trama, por lo que el error en cualquier borde no excede media iteración.
+ * serial_sw_autobaud() mide la velocidad a partir de un carácter de sincronía conocido (p. ej. 0x55 o 0x0D), y serial_sw_setBaud()
+ * elige una velocidad de la tabla precalculada en compilación (1200 a 115200) para _XTAL_FREQ. Al iniciar se usa SW_BAUDRATE. Las lecturas
+ * con tiempo límite descuentan la duración de la trama a la velocidad actual. Sólo aplica a la transmisión y recepción bloqueantes:
+ * no es compatible con SERIAL_SW_TX_ISR, SERIAL_SW_RX_ISR ni SERIAL_SW_FULL_DUPLEX, ni con SERIAL_SW_BIT_FRACCIONAL o SERIAL_SW_RX_MAYORIA.
+*/
+//#define SERIAL_SW_BAUD_VARIABLE
+
+#ifndef SERIAL_SW_CICLOS_ITERACION
+#define SERIAL_SW_CICLOS_ITERACION      8       //Ciclos por iteración del lazo de retardo variable
+#endif
+#ifndef SERIAL_SW_CICLOS_LAZO
+#define SERIAL_SW_CICLOS_LAZO           5       //Ciclos de cada iteración que consume el propio lazo (decremento y salto)
+#endif
+#ifndef SERIAL_SW_CICLOS_MEDICION
+#define SERIAL_SW_CICLOS_MEDICION       7       //Ciclos por iteración del lazo de medición de serial_sw_autobaud()
+#endif
+#ifndef SERIAL_SW_CORRECCION_TX_BIT
+#define SERIAL_SW_CORRECCION_TX_BIT     24      //Ciclos fijos por bit transmitido, fuera del lazo de retardo
+#endif
+#ifndef SERIAL_SW_CORRECCION_RX_BIT
+#define SERIAL_SW_CORRECCION_RX_BIT     24      //Ciclos fijos por muestra, fuera del lazo de retardo
+#endif
+#ifndef SERIAL_SW_CORRECCION_RX_INICIO
+#define SERIAL_SW_CORRECCION_RX_INICIO  15      //Ciclos fijos del flanco de START a la primera muestra
+#endif
+
+typedef struct {
+    uint16_t tx[10];        //Iteraciones de retardo de cada bit transmitido (START, 8 datos, STOP)
+    uint16_t rx[9];         //Iteraciones del START a la primera muestra y entre muestras, hasta la mitad del STOP
+} serial_sw_tiempos_t;
+
+/**
+ * Validación del bit de STOP en la recepción bloqueante: una trama con STOP en bajo se descarta y se cuenta como error de trama,
+ * o como break si además todos los bits de datos están en bajo; después se espera a que la línea regrese al estado inactivo para
+ * resincronizar con el siguiente START. readByte (y con ella gets, read y readIntX) sólo entrega tramas válidas, readTimeout las
+ * descarta sin guardarlas, y pollByte informa el error. En la recepción en segundo plano las tramas inválidas siempre se descartan;
+ * con esta opción también se cuentan.
+*/
+//#define SERIAL_SW_VALIDAR_STOP
+
+typedef enum {
+    SERIAL_SW_OK = 0,       //Operación completa
+    SERIAL_SW_TIMEOUT,      //Se agotó el tiempo límite
+    SERIAL_SW_VACIO,        //No había datos (lectura sin espera)
+    SERIAL_SW_ERROR_TRAMA,  //Bit de STOP en bajo (trama descartada)
+    SERIAL_SW_BREAK         //Línea en bajo durante toda la trama (trama descartada)
+} serial_sw_estado_t;
+
 /**
  * Prototipos de funciones
 */
@@ -26,7 +223,7 @@ uint8_t serial_sw_readByte(void);
 void serial_sw_writeByte(uint8_t dato);
 void serial_sw_puts(const char *cadena);
 void serial_sw_writeLine(const char *cadena); 	
-void serial_sw_gets(uint8_t *buffer, uint16_t len);
+uint16_t serial_sw_gets(uint8_t *buffer, uint16_t len);
 void serial_sw_writeInt16(uint16_t dato);
 void serial_sw_writeInt24(uint24_t dato);
 void serial_sw_writeInt32(uint32_t dato);
@@ -36,7 +233,41 @@ uint16_t serial_sw_readInt16(void);
 uint24_t serial_sw_readInt24(void);
 uint32_t serial_sw_readInt32(void);
 float serial_sw_readFloat(void);
-void serial_sw_read(void* datos, uint16_t len);
-
-
-
+uint16_t serial_sw_read(void* datos, uint16_t len);
+serial_sw_estado_t serial_sw_readByteTimeout(uint8_t *dato, uint32_t ciclos);
+serial_sw_estado_t serial_sw_pollByte(uint8_t *dato);
+serial_sw_estado_t serial_sw_readTimeout(void* datos, uint16_t len, uint16_t *recibidos, uint32_t ciclos);
+serial_sw_estado_t serial_sw_getsTimeout(uint8_t *buffer, uint16_t len, uint16_t *recibidos, uint32_t ciclos);
+serial_sw_estado_t serial_sw_readInt16Timeout(uint16_t *dato, uint32_t ciclos);
+serial_sw_estado_t serial_sw_readInt24Timeout(uint24_t *dato, uint32_t ciclos);
+serial_sw_estado_t serial_sw_readInt32Timeout(uint32_t *dato, uint32_t ciclos);
+serial_sw_estado_t serial_sw_readFloatTimeout(float *dato, uint32_t ciclos);
+#ifdef SERIAL_SW_TX_ISR
+void serial_sw_tx_isr(void);
+void serial_sw_flush(void);
+uint16_t serial_sw_txPending(void);
+#endif
+#ifdef SERIAL_SW_RX_ISR
+#ifdef SERIAL_SW_FULL_DUPLEX
+void serial_sw_fd_isr(void);
+#else
+void serial_sw_rx_edge_isr(void);
+void serial_sw_rx_timer_isr(void);
+#endif
+uint16_t serial_sw_available(void);
+#endif
+#ifdef SERIAL_SW_VALIDAR_STOP
+uint16_t serial_sw_getErroresTrama(void);
+uint16_t serial_sw_getBreaks(void);
+void serial_sw_clearErrores(void);
+#endif
+#ifdef SERIAL_SW_BAUD_VARIABLE
+bool serial_sw_autobaud(uint8_t sincronia);
+uint32_t serial_sw_getBaud(void);
+bool serial_sw_setBaud(uint32_t baud);
+#endif
+#ifdef SERIAL_SW_TX_LANES
+void serial_sw_lanes_init(uint8_t mascara);
+void serial_sw_lanes_writeByte(const uint8_t *datos);
+void serial_sw_lanes_puts(const char **cadenas);
+#endif
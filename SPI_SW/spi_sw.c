@@ -11,6 +11,185 @@
 #include "spi_sw.h"
 #include "../../utils/utils.h"
 
+#ifdef SPI_SW_LANES
+static uint8_t spi_sw_lanes_mascara;    //Canales MOSI en uso
+
+/**
+ * @brief Función interna que transpone 8 bytes (uno por canal) en 8 planos de bits, del más al menos significativo.
+ * Cada plano ya contiene el valor completo a escribir en el registro LAT del puerto de canales.
+ * @param datos (const uint8_t *): 8 bytes, datos[n] corresponde al canal n
+ * @param planos (uint8_t *): 8 planos de bits resultantes
+ * @param resto (uint8_t): Estado de los pines del puerto que no son canales
+ * @return (void)
+*/
+static void spi_sw_lanes_transponer(const uint8_t *datos, uint8_t *planos, uint8_t resto) {
+    uint8_t copia[8], i, canal, plano;
+    for(canal=0;canal!=8;canal++)
+        copia[canal] = datos[canal];
+    for(i=0;i!=8;i++) {
+        plano = 0;
+        for(canal=8;canal;) {
+            canal--;
+            plano <<= 1;
+            if(copia[canal] & 0x80)
+                plano |= 0x01;
+            copia[canal] <<= 1;
+        }
+        planos[i] = (plano & spi_sw_lanes_mascara) | resto;
+    }
+}
+#endif
+
+/*
+    Retardo por medio periodo de reloj SCK. Sin retardo en la ruta de máxima velocidad.
+*/
+#if SPI_SW_CICLOS_MEDIO_PERIODO > 0
+#define SPI_SW_RETARDO() _delay(SPI_SW_CICLOS_MEDIO_PERIODO)
+#else
+#define SPI_SW_RETARDO()
+#endif
+
+/*
+    Funciones de transferencia especializadas por modo, generadas a partir de la plantilla spi_sw_modo.h
+*/
+#ifndef SPI_SW_FIXED_MODE
+typedef struct {
+    void (*write)(tipo_dato_tx_spi_sw dato_tx);
+    void (*writeByte)(uint8_t dato_tx);
+    uint8_t (*readByte)(void);
+    tipo_dato_rx_spi_sw (*read)(void);
+    uint8_t (*xmit)(uint8_t dato_tx);
+    void (*transfer)(const uint8_t *tx, uint8_t *rx, uint16_t len);
+    void (*writeBuffer)(const uint8_t *tx, uint16_t len);
+    void (*readBuffer)(uint8_t *rx, uint16_t len);
+#ifdef SPI_SW_LANES
+    void (*lanes_writeByte)(const uint8_t *datos);
+#endif
+} spi_sw_funciones_t;
+#endif
+
+#define SPI_SW_FN_CONCAT(nombre,sufijo) nombre##_##sufijo
+#define SPI_SW_FN_(nombre,sufijo) SPI_SW_FN_CONCAT(nombre,sufijo)
+
+#ifdef SPI_SW_FIXED_MODE
+//Modo único: la plantilla genera directamente las funciones públicas
+#define SPI_SW_FN(nombre) nombre
+#define SPI_SW_M_CLASE
+#define SPI_SW_M_INACTIVO       SPI_SW_FIXED_IDLE
+#if SPI_SW_FIXED_MODE == SPI_SW_MODE_00 || SPI_SW_FIXED_MODE == SPI_SW_MODE_11
+#define SPI_SW_M_MUESTREO       1
+#define SPI_SW_M_PROPAGACION    0
+#else
+#define SPI_SW_M_MUESTREO       0
+#define SPI_SW_M_PROPAGACION    1
+#endif
+#include "spi_sw_modo.h"
+
+#else
+//Varios modos: cada modo genera sus funciones con sufijo y su tabla de funciones
+#define SPI_SW_FN(nombre) SPI_SW_FN_(nombre,SPI_SW_M_SUFIJO)
+#define SPI_SW_M_CLASE static
+
+#if SPI_SW_MODES & (1<<SPI_SW_MODE_00)
+#define SPI_SW_M_SUFIJO         modo0
+#define SPI_SW_M_INACTIVO       0
+#define SPI_SW_M_MUESTREO       1
+#define SPI_SW_M_PROPAGACION    0
+#include "spi_sw_modo.h"
+#endif
+
+#if SPI_SW_MODES & (1<<SPI_SW_MODE_01)
+#define SPI_SW_M_SUFIJO         modo1
+#define SPI_SW_M_INACTIVO       0
+#define SPI_SW_M_MUESTREO       0
+#define SPI_SW_M_PROPAGACION    1
+#include "spi_sw_modo.h"
+#endif
+
+#if SPI_SW_MODES & (1<<SPI_SW_MODE_10)
+#define SPI_SW_M_SUFIJO         modo2
+#define SPI_SW_M_INACTIVO       1
+#define SPI_SW_M_MUESTREO       0
+#define SPI_SW_M_PROPAGACION    1
+#include "spi_sw_modo.h"
+#endif
+
+#if SPI_SW_MODES & (1<<SPI_SW_MODE_11)
+#define SPI_SW_M_SUFIJO         modo3
+#define SPI_SW_M_INACTIVO       1
+#define SPI_SW_M_MUESTREO       1
+#define SPI_SW_M_PROPAGACION    0
+#include "spi_sw_modo.h"
+#endif
+
+//Modo predeterminado: el modo 0 si fue compilado, en caso contrario el primer modo de SPI_SW_MODES
+#if SPI_SW_MODES & (1<<SPI_SW_MODE_00)
+#define SPI_SW_MODO_DEFECTO     SPI_SW_MODE_00
+#define SPI_SW_TABLA_DEFECTO    spi_sw_tabla_modo0
+#elif SPI_SW_MODES & (1<<SPI_SW_MODE_01)
+#define SPI_SW_MODO_DEFECTO     SPI_SW_MODE_01
+#define SPI_SW_TABLA_DEFECTO    spi_sw_tabla_modo1
+#elif SPI_SW_MODES & (1<<SPI_SW_MODE_10)
+#define SPI_SW_MODO_DEFECTO     SPI_SW_MODE_10
+#define SPI_SW_TABLA_DEFECTO    spi_sw_tabla_modo2
+#elif SPI_SW_MODES & (1<<SPI_SW_MODE_11)
+#define SPI_SW_MODO_DEFECTO     SPI_SW_MODE_11
+#define SPI_SW_TABLA_DEFECTO    spi_sw_tabla_modo3
+#else
+#error "SPI_SW_MODES no incluye ningún modo"
+#endif
+
+//Tabla del modo actual
+static const spi_sw_funciones_t *spi_sw_funciones = &SPI_SW_TABLA_DEFECTO;
+
+/**
+ * Funciones públicas de transferencia: una llamada por transferencia a la versión del modo actual
+ */
+void spi_sw_write(tipo_dato_tx_spi_sw dato_tx) {
+    spi_sw_funciones->write(dato_tx);
+}
+
+void spi_sw_writeByte(uint8_t dato_tx) {
+    spi_sw_funciones->writeByte(dato_tx);
+}
+
+uint8_t spi_sw_readByte() {
+    return spi_sw_funciones->readByte();
+}
+
+tipo_dato_rx_spi_sw spi_sw_read() {
+    return spi_sw_funciones->read();
+}
+
+uint8_t spi_sw_xmit(uint8_t dato_tx) {
+    return spi_sw_funciones->xmit(dato_tx);
+}
+
+void spi_sw_transfer(const uint8_t *tx, uint8_t *rx, uint16_t len) {
+    spi_sw_funciones->transfer(tx,rx,len);
+}
+
+void spi_sw_writeBuffer(const uint8_t *tx, uint16_t len) {
+    spi_sw_funciones->writeBuffer(tx,len);
+}
+
+void spi_sw_readBuffer(uint8_t *rx, uint16_t len) {
+    spi_sw_funciones->readBuffer(rx,len);
+}
+
+#ifdef SPI_SW_LANES
+void spi_sw_lanes_writeByte(const uint8_t *datos) {
+    spi_sw_funciones->lanes_writeByte(datos);
+}
+#endif
+#endif
+
+#ifdef SPI_SW_FIXED_MODE
+#define SPI_SW_MODO_DEFECTO SPI_SW_FIXED_MODE
+#endif
+static uint8_t spi_sw_mode = SPI_SW_MODO_DEFECTO;
+
+
 //Inicializacion del bus SPI por software en el modo adecuado
 /**
  * 
@@ -28,38 +207,48 @@ void spi_sw_init(uint8_t mode) {
 
 //Función para cambiar de modo SPI por software. Se uitiliza cuando en el bus se tienen dispositivos con modos de funcionamiento diferentes
 /**
- * 
+ * Con SPI_SW_FIXED_MODE sólo existe un modo y el argumento se ignora; en caso contrario se selecciona la tabla de funciones
+ * especializadas del modo solicitado. Un modo inválido o no compilado en SPI_SW_MODES selecciona el modo predeterminado (el 0,
+ * o el primer modo compilado si el 0 se excluyó). En todos los casos el reloj queda en el estado inactivo del modo elegido.
  */
 void spi_sw_setMode(uint8_t newMode) {
-    //Según el modo SPI, se configuran flanco de propagación y muestreo y estado
-    //inactivo del reloj.
-    switch(newMode) { //Inicialización de la terminal de reloj según el modo SPI a configurar
+#ifdef SPI_SW_FIXED_MODE
+    (void)newMode;
+    spi_sw_mode = SPI_SW_FIXED_MODE;
+    SPI_SW_SCK = SPI_SW_FIXED_IDLE; //Inicializa reloj en estado inactivo
+#else
+    //Según el modo SPI, se selecciona la versión de las funciones con los flancos de propagación y muestreo y el estado
+    //inactivo del reloj correspondientes.
+    switch(newMode) {
+    #if SPI_SW_MODES & (1<<SPI_SW_MODE_00)
+        case SPI_SW_MODE_00:
+            spi_sw_funciones = &spi_sw_tabla_modo0;
+            break;
+    #endif
+    #if SPI_SW_MODES & (1<<SPI_SW_MODE_01)
         case SPI_SW_MODE_01:
-            spi_sw_mode = SPI_SW_MODE_01;
-            estado_inactivo_reloj = 0; //Estado inactivo en bajo (idle low)
-            flanco_muestreo = 0;
-            flanco_propagacion = 1;
+            spi_sw_funciones = &spi_sw_tabla_modo1;
             break;
+    #endif
+    #if SPI_SW_MODES & (1<<SPI_SW_MODE_10)
         case SPI_SW_MODE_10:
-            spi_sw_mode = SPI_SW_MODE_10;
-            estado_inactivo_reloj = 1; //Estado inactivo en alto (idle high)
-            flanco_muestreo = 0;
-            flanco_propagacion = 1;
+            spi_sw_funciones = &spi_sw_tabla_modo2;
             break;
+    #endif
+    #if SPI_SW_MODES & (1<<SPI_SW_MODE_11)
         case SPI_SW_MODE_11:
-            spi_sw_mode = SPI_SW_MODE_11;
-            estado_inactivo_reloj = 1; //Estado inactivo en alto (idle high)
-            flanco_muestreo = 1; 
-            flanco_propagacion = 0; 
+            spi_sw_funciones = &spi_sw_tabla_modo3;
             break;
-        default: //Modo SPI 0 es el predeterminado
-            spi_sw_mode = SPI_SW_MODE_00;
-            estado_inactivo_reloj = 0; //Estado inactivo en bajo (idle low)
-            flanco_muestreo = 1; 
-            flanco_propagacion = 0; 
+    #endif
+        default: //Modo inválido o no compilado: modo predeterminado
+            newMode = SPI_SW_MODO_DEFECTO;
+            spi_sw_funciones = &SPI_SW_TABLA_DEFECTO;
             break;
     }
-    SPI_SW_SCK = estado_inactivo_reloj; //Inicializa reloj en estado inactivo
+    spi_sw_mode = newMode;
+    //Inicializa reloj en estado inactivo: bajo en modos 0 y 1 (idle low), alto en modos 2 y 3 (idle high)
+    SPI_SW_SCK = (newMode == SPI_SW_MODE_10 || newMode == SPI_SW_MODE_11);
+#endif
 }
 
 /*
@@ -73,137 +262,19 @@ uint8_t spi_sw_getMode() {
 }
 
 /**
- * 
+ * @brief Función que obtiene la frecuencia de reloj SCK obtenida con la configuración SPI_SW_SCK_HZ y _XTAL_FREQ
+ * @param (void)
+ * @return (uint32_t) Frecuencia de SCK en Hz
  */
-void spi_sw_write(tipo_dato_tx_spi_sw dato_tx) {
-    #if SPI_SW_NUM_BITS_TX>8
-        uint16_t mask=(0x0001<<(SPI_SW_NUM_BITS_TX-1));
-    #else
-        uint8_t mask=(0x01<<(SPI_SW_NUM_BITS_TX-1));
-    #endif
-    //Todos los modos SPI comienzan en estado de propagación, por tanto:
-    SPI_SW_SCK = flanco_propagacion;
-    __delay_us(1);
-    //A continuacion el corrimiento de bits
-    for(uint8_t contador=SPI_SW_NUM_BITS_TX;contador;contador--) {
-        //Establece MOSI con el estado del bit más significativo del dato a transmitir
-        SPI_SW_MOSI =(dato_tx & mask)? 1:0; 
-        dato_tx<<=1; //Corrimiento a la izquierda del dato
-        SPI_SW_SCK = flanco_muestreo;
-        __delay_us(1);
-        if(contador!=1) //En el último pulso de reloj, se deja sin flanco de propagacion
-            SPI_SW_SCK = flanco_propagacion; 
-    }  
-    //Al final regresa al reloj a su estado inactivo
-    SPI_SW_SCK = estado_inactivo_reloj;
-    
-}
-
-/**
- * 
- */
-void spi_sw_writeByte(uint8_t dato_tx) {
-    uint8_t mask=0x80, i;
-    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
-    SPI_SW_SCK = flanco_propagacion;
-    __delay_us(1);
-    //A continuacion el corrimiento de bits
-    for( i = 8; i ; i-- )
-    {
-        SPI_SW_MOSI =(dato_tx & mask)? 1:0; //Establece MOSI con el estado del bit m�s significativo del dato a transmitir
-        //En cualquier modo SPI, los datos est�n listos antes de cualquier pulso de reloj
-        dato_tx<<=1; //Corrimiento a la izquierda del dato
-        SPI_SW_SCK = flanco_muestreo;
-        __delay_us(1);
-        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
-            SPI_SW_SCK = flanco_propagacion;    
-    }    
-    //Al final regresa al reloj a su estado inactivo
-    SPI_SW_SCK = estado_inactivo_reloj;
-}
-
-/**
- * 
- */
-uint8_t spi_sw_readByte() {
-    uint8_t dato=0,i;
-    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
-    SPI_SW_SCK = flanco_propagacion;
-    __delay_us(1);
-    SPI_SW_MOSI = 0; //Por default, manda 0x0000
-    for (i = 8; i ; i--) {
-        dato <<= 1;
-        SPI_SW_SCK = flanco_muestreo;
-        if(SPI_SW_MISO)
-            dato|=0x01;
-        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
-            SPI_SW_SCK = flanco_propagacion; 
-    }
-    //Al final regresa al reloj a su estado inactivo
-    SPI_SW_SCK = estado_inactivo_reloj;
-    return dato;
-}
-
-/**
- * 
- */
-tipo_dato_rx_spi_sw spi_sw_read() {
-    #if SPI_SW_NUM_BITS_TX>8
-        uint16_t dato = 0;
-    #else
-        uint8_t dato = 0;
-    #endif
-    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
-    SPI_SW_SCK = flanco_propagacion;
-    __delay_us(1);
-    SPI_SW_MOSI = 0; //Por default, manda 0x0000
-    for (uint8_t i = SPI_SW_NUM_BITS_RX; i ;  i--) {
-        dato <<= 1;
-        SPI_SW_SCK = flanco_muestreo;
-        if(SPI_SW_MISO)
-            dato|=0x01;
-        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
-            SPI_SW_SCK = flanco_propagacion; 
-        
-    }
-    //Al final regresa al reloj a su estado inactivo
-    SPI_SW_SCK = estado_inactivo_reloj;
-    return dato;
-}
-
-/**
- * 
- */
-//Por verificar funcionamiento, por el momento solo con 1 byte a transmitir y uno a recibir
-uint8_t spi_sw_xmit(uint8_t dato_tx) {
-    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
-    SPI_SW_SCK = flanco_propagacion;
-    __delay_us(1);
-    uint8_t i, mask=0x80;//(0x01<<(SPI_NUM_BITS_TX-1));
-    for( i = 8 ; i ; i--) {
-        SPI_SW_MOSI = ( dato_tx & mask )? 1:0; //Establece MOSI con el estado del bit más significativo del dato a transmitir
-        //En cualquier modo SPI, los datos están listos antes de cualquier pulso de reloj
-        dato_tx <<= 1; //Corrimiento a la izquierda del dato
-
-        SPI_SW_SCK = flanco_muestreo;
-        if(SPI_SW_MISO)
-            dato_tx|=0x01;
-        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
-            SPI_SW_SCK = flanco_propagacion;    
-    }    
-    //Al final regresa al reloj a su estado inactivo
-    SPI_SW_SCK = estado_inactivo_reloj;
-    return dato_tx;  
+uint32_t spi_sw_getFrequency() {
+    return SPI_SW_SCK_HZ_REAL;
 }
 
 /**
  * 
  */
 void spi_sw_writeInt16(uint16_t dato_tx) {
-    uint8_t i;
-    for(i=0;i!=sizeof(uint16_t);i++) {
-        spi_sw_writeByte(*((uint8_t *)&dato_tx+i));
-    }
+    spi_sw_writeBuffer((const uint8_t *)&dato_tx,sizeof(uint16_t));
 }
 
 /**
@@ -211,11 +282,7 @@ void spi_sw_writeInt16(uint16_t dato_tx) {
  */
 uint16_t spi_sw_readInt16() {
     uint16_t dato_leido=0;
-    uint8_t * p_lectura;                    //Apuntador a variable entera de 16 bits
-    p_lectura = (uint8_t *)&dato_leido;     //Asigna dirección de valor de retorno de tipo entero de 16 bits
-    for(uint8_t i=0;i!=sizeof(uint16_t);i++) {
-        *(p_lectura++) = spi_sw_readByte();      //Recepción de datos
-    }
+    spi_sw_readBuffer((uint8_t *)&dato_leido,sizeof(uint16_t));      //Recepción de datos
     return dato_leido;
 }
 
@@ -223,10 +290,7 @@ uint16_t spi_sw_readInt16() {
  * 
  */
 void spi_sw_writeInt24(uint24_t dato_tx) {
-    uint8_t i;
-    for(i=0;i!=sizeof(uint24_t);i++) {
-        spi_sw_writeByte(*((uint8_t *)&dato_tx+i));
-    }
+    spi_sw_writeBuffer((const uint8_t *)&dato_tx,sizeof(uint24_t));
 }
 
 /**
@@ -234,11 +298,7 @@ void spi_sw_writeInt24(uint24_t dato_tx) {
  */
 uint24_t spi_sw_readInt24() {
     uint24_t dato_leido=0;
-    uint8_t * p_lectura;                    //Apuntador a variable entera de 24 bits
-    p_lectura = (uint8_t *)&dato_leido;     //Asigna dirección de valor de retorno de tipo entero de 24 bits
-    for(uint8_t i=0;i!=sizeof(uint24_t);i++) {
-        *(p_lectura++) = spi_sw_readByte();      //Recepción de datos
-    }
+    spi_sw_readBuffer((uint8_t *)&dato_leido,sizeof(uint24_t));      //Recepción de datos
     return dato_leido;
 }
 
@@ -246,10 +306,7 @@ uint24_t spi_sw_readInt24() {
  * 
  */
 void spi_sw_writeInt32(uint32_t dato_tx) {
-    uint8_t i;
-    for(i=0;i!=sizeof(uint32_t);i++) {
-        spi_sw_writeByte(*((uint8_t *)&dato_tx+i));
-    }
+    spi_sw_writeBuffer((const uint8_t *)&dato_tx,sizeof(uint32_t));
 }
 
 /**
@@ -257,11 +314,7 @@ void spi_sw_writeInt32(uint32_t dato_tx) {
  */
 uint32_t spi_sw_readInt32() {
     uint32_t dato_leido=0;
-    uint8_t * p_lectura;                    //Apuntador a variable entera de 32 bits
-    p_lectura = (uint8_t *)&dato_leido;     //Asigna dirección de valor de retorno de tipo entero de 32 bits
-    for(uint8_t i=0;i!=sizeof(uint32_t);i++) {
-        *(p_lectura++) = spi_sw_readByte();      //Recepción de datos
-    }
+    spi_sw_readBuffer((uint8_t *)&dato_leido,sizeof(uint32_t));      //Recepción de datos
     return dato_leido;
 }
 
@@ -269,10 +322,7 @@ uint32_t spi_sw_readInt32() {
  * 
  */
 void spi_sw_writeFloat(float dato_tx) {
-    uint8_t i;
-    for(i=0;i!=sizeof(float);i++) {
-        spi_sw_writeByte(*((uint8_t *)&dato_tx+i));
-    } 
+    spi_sw_writeBuffer((const uint8_t *)&dato_tx,sizeof(float));
 }
 
 /**
@@ -280,11 +330,32 @@ void spi_sw_writeFloat(float dato_tx) {
  */
 float spi_sw_readFloat() {
     float dato_leido;
-    uint8_t * p_lectura;                    //Apuntador a variable flotante
-    p_lectura = (uint8_t *)&dato_leido;     //Asigna dirección de valor de retorno de tipo flotante
-    for(uint8_t i=0;i!=sizeof(float);i++) {
-        *(p_lectura++) = spi_sw_readByte();      //Recepción de datos
-    }
+    spi_sw_readBuffer((uint8_t *)&dato_leido,sizeof(float));      //Recepción de datos
     return dato_leido;
 }
 
+#ifdef SPI_SW_LANES
+/**
+ * @brief Función de configuración del modo SPI multicanal. El reloj SCK se configura con spi_sw_init().
+ * @param mascara (uint8_t): Canales a utilizar (bit n = canal n del puerto SPI_SW_LANES_LAT). El resto de los pines del puerto no se modifica.
+ * @return (void)
+*/
+void spi_sw_lanes_init(uint8_t mascara) {
+    spi_sw_lanes_mascara = mascara;
+    SPI_SW_LANES_LAT &= ~mascara;
+    SPI_SW_LANES_TRIS &= ~mascara;
+}
+
+/**
+ * @brief Función para escribir una secuencia de bytes en cada canal de manera simultánea
+ * @param datos (const uint8_t *): Arreglo de len grupos de 8 bytes; el byte k del canal n se encuentra en datos[8*k+n]
+ * @param len (uint16_t): Cantidad de bytes por canal
+ * @return (void)
+*/
+void spi_sw_lanes_write(const uint8_t *datos, uint16_t len) {
+    while(len--) {
+        spi_sw_lanes_writeByte(datos);
+        datos += 8;
+    }
+}
+#endif
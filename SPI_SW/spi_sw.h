@@ -36,6 +36,51 @@
 #define SPI_SW_MODE_10	2
 #define SPI_SW_MODE_11	3
 
+/**
+ * Selección de modos en tiempo de compilación. Las funciones de transferencia se generan a partir de la plantilla spi_sw_modo.h
+ * con los flancos de reloj como constantes, por lo que el lazo de cada bit no consulta el modo actual.
+ * SPI_SW_FIXED_MODE: si se define con alguno de los modos anteriores, sólo se compila dicho modo y spi_sw_setMode() ignora su argumento.
+ * SPI_SW_MODES: en caso contrario, máscara de modos a compilar (bit n = modo n). spi_sw_setMode() elige la versión de las funciones
+ * mediante una tabla, con una sola llamada indirecta por transferencia.
+*/
+//#define SPI_SW_FIXED_MODE SPI_SW_MODE_00
+
+#ifndef SPI_SW_MODES
+#define SPI_SW_MODES 0x0F
+#endif
+
+#ifdef SPI_SW_FIXED_MODE
+	#if SPI_SW_FIXED_MODE == SPI_SW_MODE_10 || SPI_SW_FIXED_MODE == SPI_SW_MODE_11
+		#define SPI_SW_FIXED_IDLE 1
+	#else
+		#define SPI_SW_FIXED_IDLE 0
+	#endif
+#endif
+
+/**
+ * Frecuencia de reloj SCK en Hz. El retardo por medio periodo se calcula en tiempo de compilación a partir de _XTAL_FREQ,
+ * descontando el costo del lazo de cada bit (SPI_SW_CICLOS_BIT, estimado para PIC18). Con SPI_SW_SCK_HZ en 0 (predeterminado), o si
+ * la frecuencia solicitada supera lo que permite el núcleo, no se insertan retardos y el reloj alterna tan rápido como el lazo lo permite.
+ * La frecuencia obtenida (nunca mayor a la solicitada) se publica en SPI_SW_SCK_HZ_REAL y mediante spi_sw_getFrequency().
+*/
+#ifndef SPI_SW_SCK_HZ
+#define SPI_SW_SCK_HZ 0
+#endif
+
+#ifndef SPI_SW_CICLOS_BIT
+#define SPI_SW_CICLOS_BIT 12    //Ciclos de instrucción por bit sin retardos
+#endif
+
+#if SPI_SW_SCK_HZ
+	//Periodo completo redondeado hacia arriba; el retardo restante se reparte en dos medios periodos, también hacia arriba
+	#define SPI_SW_CICLOS_PERIODO_IDEAL (((_XTAL_FREQ/4)+SPI_SW_SCK_HZ-1)/SPI_SW_SCK_HZ)
+	#define SPI_SW_CICLOS_MEDIO_PERIODO ((SPI_SW_CICLOS_PERIODO_IDEAL > SPI_SW_CICLOS_BIT)? \
+		((SPI_SW_CICLOS_PERIODO_IDEAL - SPI_SW_CICLOS_BIT + 1)/2) : 0)
+#else
+	#define SPI_SW_CICLOS_MEDIO_PERIODO 0
+#endif
+#define SPI_SW_SCK_HZ_REAL ((_XTAL_FREQ/4)/(2*SPI_SW_CICLOS_MEDIO_PERIODO+SPI_SW_CICLOS_BIT))
+
 /**
  * Definición de tipos de datos según bits necesarios
  */
@@ -74,6 +119,17 @@ typedef uint8_t tipo_dato_rx_spi_sw;
 #define SPI_SW_SCK_TRIS TRISBbits.TRISB2
 #endif
 
+/**
+ * Modo SPI multicanal (bit-sliced): hasta 8 líneas MOSI independientes en un mismo puerto, que comparten el reloj SPI_SW_SCK.
+ * Los bytes de cada canal se transponen en planos de bits, de modo que cada flanco de reloj corresponde a una sola escritura
+ * al registro LAT del puerto de canales. El bit n del puerto corresponde al canal n.
+*/
+//#define SPI_SW_LANES
+
+#ifndef SPI_SW_LANES_LAT
+#define SPI_SW_LANES_LAT    LATD
+#define SPI_SW_LANES_TRIS   TRISD
+#endif
 
 /**
  * Prototipos de funciones  
@@ -81,14 +137,20 @@ typedef uint8_t tipo_dato_rx_spi_sw;
 void spi_sw_init(uint8_t mode);
 void spi_sw_setMode(uint8_t newMode);        //Establece nuevo modo SPI en caso de usar dispositivos con otros modos de funcionamiento
 uint8_t spi_sw_getMode();                     //Lectura del modo actual SPI
+uint32_t spi_sw_getFrequency();               //Frecuencia de reloj SCK obtenida, en Hz
 void spi_sw_writeByte(uint8_t dato_tx);       //Escribe un byte
 uint8_t spi_sw_readByte();                   //Lee un byte
 void spi_sw_write(tipo_dato_tx_spi_sw dato_tx);	   //Escribe un dato de longitud predefinida SPI_SW_NUM_BITS_TX
 tipo_dato_rx_spi_sw spi_sw_read();					//Lee un dato de longitud predefinida SPI_SW_NUM_BITS_RX
 
-//Funcion de transmisión y recepción simultánea de datos. Por el momento solo se puede utilizar con bytes individuales
+//Funcion de transmisión y recepción simultánea de un byte; para bloques de varios bytes se utiliza spi_sw_transfer
 uint8_t spi_sw_xmit(uint8_t dato_tx);
 
+//Funciones de transferencia de bloques de bytes, con SCK en fase entre bytes (tx o rx pueden ser 0 en spi_sw_transfer)
+void spi_sw_transfer(const uint8_t *tx, uint8_t *rx, uint16_t len);
+void spi_sw_writeBuffer(const uint8_t *tx, uint16_t len);
+void spi_sw_readBuffer(uint8_t *rx, uint16_t len);
+
 //Macros de reloj SCK para transmision de datos en flanco ascendente/descendente
 #define SPI_SW_SCK_PULSE_HIGH	SPI_SW_SCK=1;SPI_SW_SCK=0;
 #define SPI_SW_SCK_PULSE_LOW	SPI_SW_SCK=0;SPI_SW_SCK=1;
@@ -105,9 +167,11 @@ uint32_t spi_sw_readInt32();
 void spi_sw_writeFloat(float dato_tx);
 float spi_sw_readFloat();
 
-//Variables internas
-static uint8_t spi_sw_mode;
-static bool flanco_muestreo, flanco_propagacion, estado_inactivo_reloj;
+#ifdef SPI_SW_LANES
+void spi_sw_lanes_init(uint8_t mascara);                        //Configura como salidas los canales indicados en la máscara
+void spi_sw_lanes_writeByte(const uint8_t *datos);              //Escribe un byte por canal, datos[n] en el canal n (8 bytes)
+void spi_sw_lanes_write(const uint8_t *datos, uint16_t len);    //Escribe len bytes por canal, en grupos de 8 bytes (uno por canal)
+#endif
 
 #endif	/* SPI_SW_H */
 
@@ -0,0 +1,266 @@
+/**
+ * @file spi_sw_modo.h
+ * @brief Plantilla de funciones de transferencia SPI por software especializadas para un modo. Se incluye desde spi_sw.c una vez por
+ * cada modo a compilar, con los flancos definidos como constantes, de modo que el lazo de cada bit no consulta variables de modo.
+ * Parámetros (se eliminan al final de la plantilla):
+ *  SPI_SW_M_MUESTREO       Nivel de SCK en el flanco de muestreo
+ *  SPI_SW_M_PROPAGACION    Nivel de SCK en el flanco de propagación
+ *  SPI_SW_M_INACTIVO       Nivel de SCK en estado inactivo
+ *  SPI_SW_M_SUFIJO         Sufijo de los nombres de función (sólo con tabla de modos)
+ * Cada bit dura SPI_SW_RETARDO() antes y después del flanco de muestreo, más el costo del lazo (SPI_SW_CICLOS_BIT).
+ * @author Ing. José Roberto Parra Trewartha
+*/
+
+/**
+ *
+ */
+SPI_SW_M_CLASE void SPI_SW_FN(spi_sw_write)(tipo_dato_tx_spi_sw dato_tx) {
+    #if SPI_SW_NUM_BITS_TX>8
+        uint16_t mask=(0x0001<<(SPI_SW_NUM_BITS_TX-1));
+    #else
+        uint8_t mask=(0x01<<(SPI_SW_NUM_BITS_TX-1));
+    #endif
+    //Todos los modos SPI comienzan en estado de propagación, por tanto:
+    SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    //A continuacion el corrimiento de bits
+    for(uint8_t contador=SPI_SW_NUM_BITS_TX;contador;contador--) {
+        //Establece MOSI con el estado del bit más significativo del dato a transmitir
+        SPI_SW_MOSI =(dato_tx & mask)? 1:0;
+        dato_tx<<=1; //Corrimiento a la izquierda del dato
+        SPI_SW_RETARDO();
+        SPI_SW_SCK = SPI_SW_M_MUESTREO;
+        SPI_SW_RETARDO();
+        if(contador!=1) //En el último pulso de reloj, se deja sin flanco de propagacion
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+}
+
+/**
+ *
+ */
+SPI_SW_M_CLASE void SPI_SW_FN(spi_sw_writeByte)(uint8_t dato_tx) {
+    uint8_t mask=0x80, i;
+    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
+    SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    //A continuacion el corrimiento de bits
+    for( i = 8; i ; i-- )
+    {
+        SPI_SW_MOSI =(dato_tx & mask)? 1:0; //Establece MOSI con el estado del bit más significativo del dato a transmitir
+        //En cualquier modo SPI, los datos están listos antes de cualquier pulso de reloj
+        dato_tx<<=1; //Corrimiento a la izquierda del dato
+        SPI_SW_RETARDO();
+        SPI_SW_SCK = SPI_SW_M_MUESTREO;
+        SPI_SW_RETARDO();
+        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+}
+
+/**
+ *
+ */
+SPI_SW_M_CLASE uint8_t SPI_SW_FN(spi_sw_readByte)() {
+    uint8_t dato=0,i;
+    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
+    SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    SPI_SW_MOSI = 0; //Por default, manda 0x0000
+    for (i = 8; i ; i--) {
+        dato <<= 1;
+        SPI_SW_RETARDO();
+        SPI_SW_SCK = SPI_SW_M_MUESTREO;
+        if(SPI_SW_MISO)
+            dato|=0x01;
+        SPI_SW_RETARDO();
+        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+    return dato;
+}
+
+/**
+ *
+ */
+SPI_SW_M_CLASE tipo_dato_rx_spi_sw SPI_SW_FN(spi_sw_read)() {
+    #if SPI_SW_NUM_BITS_TX>8
+        uint16_t dato = 0;
+    #else
+        uint8_t dato = 0;
+    #endif
+    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
+    SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    SPI_SW_MOSI = 0; //Por default, manda 0x0000
+    for (uint8_t i = SPI_SW_NUM_BITS_RX; i ;  i--) {
+        dato <<= 1;
+        SPI_SW_RETARDO();
+        SPI_SW_SCK = SPI_SW_M_MUESTREO;
+        if(SPI_SW_MISO)
+            dato|=0x01;
+        SPI_SW_RETARDO();
+        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+    return dato;
+}
+
+/**
+ * @brief Función de transmisión y recepción simultánea de un byte (full-duplex). Cada llamada es una transferencia completa de
+ * 8 bits que termina con SCK en estado inactivo; llamadas consecutivas transfieren bytes consecutivos. Para bloques con SCK en
+ * fase entre bytes se utiliza spi_sw_transfer().
+ * @param dato_tx (uint8_t): Byte a transmitir
+ * @return (uint8_t) Byte recibido
+*/
+SPI_SW_M_CLASE uint8_t SPI_SW_FN(spi_sw_xmit)(uint8_t dato_tx) {
+    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
+    SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    uint8_t i, mask=0x80;//(0x01<<(SPI_NUM_BITS_TX-1));
+    for( i = 8 ; i ; i--) {
+        SPI_SW_MOSI = ( dato_tx & mask )? 1:0; //Establece MOSI con el estado del bit más significativo del dato a transmitir
+        //En cualquier modo SPI, los datos están listos antes de cualquier pulso de reloj
+        dato_tx <<= 1; //Corrimiento a la izquierda del dato
+        SPI_SW_RETARDO();
+        SPI_SW_SCK = SPI_SW_M_MUESTREO;
+        if(SPI_SW_MISO)
+            dato_tx|=0x01;
+        SPI_SW_RETARDO();
+        if(i!=1) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+    return dato_tx;
+}
+
+/**
+ * @brief Función de transferencia full-duplex de un bloque de bytes. SCK permanece en fase entre bytes: no regresa al estado
+ * inactivo ni repite la preparación inicial, por lo que el bloque completo se transmite como una sola secuencia de bits.
+ * @param tx (const uint8_t *): Bytes a transmitir, o 0 para transmitir 0x00
+ * @param rx (uint8_t *): Arreglo donde se guardan los bytes recibidos, o 0 para descartarlos
+ * @param len (uint16_t): Cantidad de bytes
+ * @return (void)
+*/
+SPI_SW_M_CLASE void SPI_SW_FN(spi_sw_transfer)(const uint8_t *tx, uint8_t *rx, uint16_t len) {
+    uint8_t dato, i;
+    while(len--) {
+        dato = tx? *tx++ : 0x00;
+        for(i=8;i;i--) {
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+            SPI_SW_MOSI = (dato & 0x80)? 1:0;
+            dato <<= 1;
+            SPI_SW_RETARDO();
+            SPI_SW_SCK = SPI_SW_M_MUESTREO;
+            if(SPI_SW_MISO)
+                dato |= 0x01;
+            SPI_SW_RETARDO();
+        }
+        if(rx)
+            *rx++ = dato;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+}
+
+/**
+ * @brief Función de escritura de un bloque de bytes, sin lectura de MISO
+ * @param tx (const uint8_t *): Bytes a transmitir
+ * @param len (uint16_t): Cantidad de bytes
+ * @return (void)
+*/
+SPI_SW_M_CLASE void SPI_SW_FN(spi_sw_writeBuffer)(const uint8_t *tx, uint16_t len) {
+    uint8_t dato, i;
+    while(len--) {
+        dato = *tx++;
+        for(i=8;i;i--) {
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+            SPI_SW_MOSI = (dato & 0x80)? 1:0;
+            dato <<= 1;
+            SPI_SW_RETARDO();
+            SPI_SW_SCK = SPI_SW_M_MUESTREO;
+            SPI_SW_RETARDO();
+        }
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+}
+
+/**
+ * @brief Función de lectura de un bloque de bytes; MOSI permanece en 0 durante toda la transferencia
+ * @param rx (uint8_t *): Arreglo donde se guardan los bytes recibidos
+ * @param len (uint16_t): Cantidad de bytes
+ * @return (void)
+*/
+SPI_SW_M_CLASE void SPI_SW_FN(spi_sw_readBuffer)(uint8_t *rx, uint16_t len) {
+    uint8_t dato, i;
+    SPI_SW_MOSI = 0;
+    while(len--) {
+        dato = 0;
+        for(i=8;i;i--) {
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+            dato <<= 1;
+            SPI_SW_RETARDO();
+            SPI_SW_SCK = SPI_SW_M_MUESTREO;
+            if(SPI_SW_MISO)
+                dato |= 0x01;
+            SPI_SW_RETARDO();
+        }
+        *rx++ = dato;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+}
+
+#ifdef SPI_SW_LANES
+/**
+ * @brief Función para escribir un byte en cada canal de manera simultánea
+ * @param datos (const uint8_t *): 8 bytes, datos[n] se transmite por el canal n (se ignoran los canales fuera de la máscara)
+ * @return (void)
+*/
+SPI_SW_M_CLASE void SPI_SW_FN(spi_sw_lanes_writeByte)(const uint8_t *datos) {
+    uint8_t planos[8], i;
+    spi_sw_lanes_transponer(datos,planos,SPI_SW_LANES_LAT & ~spi_sw_lanes_mascara);
+    //Todos los modos SPI comienzan en estado de propagacion, por tanto:
+    SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    for(i=0;i!=8;i++) {
+        SPI_SW_LANES_LAT = planos[i];   //Una sola escritura al puerto para todos los canales
+        SPI_SW_RETARDO();
+        SPI_SW_SCK = SPI_SW_M_MUESTREO;
+        SPI_SW_RETARDO();
+        if(i!=7) //En el ultimo pulso de reloj, se deja sin flanco de propagacion
+            SPI_SW_SCK = SPI_SW_M_PROPAGACION;
+    }
+    //Al final regresa al reloj a su estado inactivo
+    SPI_SW_SCK = SPI_SW_M_INACTIVO;
+}
+#endif
+
+#ifndef SPI_SW_FIXED_MODE
+/**
+ * Tabla de funciones del modo, seleccionada por spi_sw_setMode()
+*/
+static const spi_sw_funciones_t SPI_SW_FN(spi_sw_tabla) = {
+    SPI_SW_FN(spi_sw_write),
+    SPI_SW_FN(spi_sw_writeByte),
+    SPI_SW_FN(spi_sw_readByte),
+    SPI_SW_FN(spi_sw_read),
+    SPI_SW_FN(spi_sw_xmit),
+    SPI_SW_FN(spi_sw_transfer),
+    SPI_SW_FN(spi_sw_writeBuffer),
+    SPI_SW_FN(spi_sw_readBuffer),
+#ifdef SPI_SW_LANES
+    SPI_SW_FN(spi_sw_lanes_writeByte),
+#endif
+};
+#endif
+
+#undef SPI_SW_M_MUESTREO
+#undef SPI_SW_M_PROPAGACION
+#undef SPI_SW_M_INACTIVO
+#undef SPI_SW_M_SUFIJO